@@ -0,0 +1,91 @@
+﻿#include "AdaptiveThreshold.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace AutoAim {
+
+    AdaptiveThreshold::AdaptiveThreshold(int max_samples)
+        : max_samples_(max_samples),
+        ratio_(0.4f),
+        enter_(6.0f),
+        exit_(2.0f),
+        alpha_(0.2f),
+        saturation_min_(100.0f),
+        value_min_(100.0f),
+        luma_min_(50.0f),
+        number_threshold_(100.0f) {
+    }
+
+    void AdaptiveThreshold::update(const cv::Mat& frame, PixelFormat format) {
+        cv::Size size = Utils::frameSize(frame, format);
+        if (size.area() == 0) {
+            return;
+        }
+
+        // 网格步长：使采样点数不超过 max_samples_
+        int step = std::max(1, static_cast<int>(std::sqrt(
+            static_cast<double>(size.area()) / max_samples_)));
+
+        int value_hist[256] = { 0 };
+        int saturation_hist[256] = { 0 };
+        int total = 0;
+
+        for (int r = step / 2; r < size.height; r += step) {
+            const uchar* row = frame.ptr<uchar>(r);
+            for (int c = step / 2; c < size.width; c += step) {
+                int v, s;
+                if (format == PixelFormat::BGR) {
+                    const uchar* p = row + c * 3;
+                    int max_c = std::max(p[0], std::max(p[1], p[2]));
+                    int min_c = std::min(p[0], std::min(p[1], p[2]));
+                    v = max_c;
+                    s = max_c > 0 ? (max_c - min_c) * 255 / max_c : 0;
+                }
+                else {
+                    // YUV只统计亮度
+                    v = (format == PixelFormat::YUYV) ? row[c * 2] : row[c];
+                    s = 0;
+                }
+                value_hist[v]++;
+                saturation_hist[s]++;
+                total++;
+            }
+        }
+
+        // 灯条只占极少像素，取高百分位作为最亮区域亮度
+        int bright = percentile(value_hist, total, 0.995);
+        float target_value = Utils::clamp(ratio_ * bright, 30.0f, 100.0f);
+        smooth(value_min_, target_value);
+        smooth(number_threshold_, target_value);
+        smooth(luma_min_, Utils::clamp(ratio_ * 0.5f * bright, 15.0f, 50.0f));
+
+        if (format == PixelFormat::BGR) {
+            int saturated = percentile(saturation_hist, total, 0.995);
+            float target_saturation = Utils::clamp(ratio_ * saturated, 60.0f, 100.0f);
+            smooth(saturation_min_, target_saturation);
+        }
+    }
+
+    int AdaptiveThreshold::percentile(const int* hist, int total, double ratio) {
+        int target = static_cast<int>(total * ratio);
+        int count = 0;
+        for (int i = 0; i < 256; ++i) {
+            count += hist[i];
+            if (count > target) {
+                return i;
+            }
+        }
+        return 255;
+    }
+
+    void AdaptiveThreshold::smooth(Tracked& current, float target) {
+        float error = std::abs(target - current.value);
+        if (current.tracking ? error < exit_ : error <= enter_) {
+            current.tracking = false;
+            return;
+        }
+        current.tracking = true;
+        current.value += alpha_ * (target - current.value);
+    }
+
+} // namespace AutoAim
\ No newline at end of file
@@ -0,0 +1,55 @@
+﻿#ifndef ADAPTIVE_THRESHOLD_HPP
+#define ADAPTIVE_THRESHOLD_HPP
+
+#include <opencv2/opencv.hpp>
+#include "Utils.hpp"
+
+namespace AutoAim {
+
+    // 自适应分割阈值：在稀疏网格上采样亮度/饱和度统计，带滞回地平滑更新阈值
+    // 滞回有两个门限：偏差超过 enter 才开始跟随目标，跟随到偏差小于 exit 才停下
+    // 短曝光下整帧变暗，阈值随最亮区域（灯条）的亮度等比例下降
+    // BGR 输入使用 HSV 饱和度/亮度下限，YUYV/NV12 输入使用亮度阈值；颜色查找表的分割已固化，不受影响
+    class AdaptiveThreshold {
+    public:
+        explicit AdaptiveThreshold(int max_samples = 4096);
+
+        // 用当前帧更新阈值
+        void update(const cv::Mat& frame, PixelFormat format);
+
+        // 当前阈值
+        int saturationMin() const { return cvRound(saturation_min_.value); }
+        int valueMin() const { return cvRound(value_min_.value); }
+        int lumaMin() const { return cvRound(luma_min_.value); }
+        int numberThreshold() const { return cvRound(number_threshold_.value); }
+
+    private:
+        // 带滞回状态的阈值
+        struct Tracked {
+            float value;
+            bool tracking;          // 是否正在跟随目标
+
+            explicit Tracked(float initial) : value(initial), tracking(false) {}
+        };
+
+        // 由直方图求百分位
+        static int percentile(const int* hist, int total, double ratio);
+
+        // 带滞回的平滑更新
+        void smooth(Tracked& current, float target);
+
+    private:
+        int max_samples_;           // 每帧最大采样点数
+        float ratio_;               // 阈值 / 最亮区域亮度
+        float enter_;               // 开始跟随的偏差
+        float exit_;                // 停止跟随的偏差（小于 enter_）
+        float alpha_;               // 平滑系数
+        Tracked saturation_min_;    // HSV饱和度下限
+        Tracked value_min_;         // HSV亮度下限
+        Tracked luma_min_;          // YUV路径亮度阈值（全曝光时等于默认值50）
+        Tracked number_threshold_;  // 数字ROI二值化阈值
+    };
+
+} // namespace AutoAim
+
+#endif // ADAPTIVE_THRESHOLD_HPP
\ No newline at end of file
@@ -0,0 +1,68 @@
+﻿#include "Aimer.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace AutoAim {
+
+    namespace {
+        const float kLightBarLength = 0.056f;   // 灯条实际长度 (m)
+
+        // 查表范围
+        const float kMinDistance = 0.5f;
+        const float kMaxDistance = 12.0f;
+        const float kMinHeight = -2.0f;
+        const float kMaxHeight = 3.0f;
+    }
+
+    Aimer::Aimer() : camera_(), has_camera_(false) {
+        setBallistics(BallisticParams());
+    }
+
+    void Aimer::setCamera(const ShmCamera& camera) {
+        has_camera_ = camera.fx > 0.0 && camera.fy > 0.0;
+        camera_ = camera;
+    }
+
+    void Aimer::setBallistics(const BallisticParams& params, int distance_steps, int height_steps) {
+        table_.build(params, kMinDistance, kMaxDistance, kMinHeight, kMaxHeight,
+            distance_steps, height_steps);
+    }
+
+    AimAngles Aimer::aim(const ShmArmor& armor) const {
+        AimAngles angles;
+        if (!has_camera_) {
+            return angles;
+        }
+
+        // 灯条像素长度估计深度
+        float left = std::max(armor.left.width, armor.left.height);
+        float right = std::max(armor.right.width, armor.right.height);
+        float pixels = (left + right) * 0.5f;
+        if (pixels <= 0.0f) {
+            return angles;
+        }
+
+        // 瞄准点取两灯条中心的中点；外接矩形在图像左上边界处被截断，中心会偏移
+        double z = camera_.fy * kLightBarLength / pixels;
+        double u = (armor.left.cx + armor.right.cx) * 0.5;
+        double v = (armor.left.cy + armor.right.cy) * 0.5;
+        double x = (u - camera_.cx) * z / camera_.fx;
+        double y = (v - camera_.cy) * z / camera_.fy;
+
+        float distance = static_cast<float>(std::sqrt(x * x + z * z));
+        float height = static_cast<float>(-y);
+
+        AimSolution solution = table_.lookup(distance, height);
+        if (!solution.valid) {
+            solution = solveBallistic(table_.params(), distance, height);
+        }
+
+        angles.yaw = static_cast<float>(std::atan2(x, z));
+        angles.pitch = solution.pitch;
+        angles.flight_time = solution.flight_time;
+        angles.distance = distance;
+        angles.valid = solution.valid;
+        return angles;
+    }
+
+} // namespace AutoAim
\ No newline at end of file
@@ -0,0 +1,48 @@
+﻿#ifndef AIMER_HPP
+#define AIMER_HPP
+
+#include "Ballistics.hpp"
+#include "DetectionShm.hpp"
+
+// 瞄准解算：由共享内存中的装甲板计算云台角度
+// 不依赖OpenCV，读端进程（云台控制）链接 aimer 库即可使用
+
+namespace AutoAim {
+
+    // 云台瞄准角
+    struct AimAngles {
+        float yaw;              // 弧度，向右为正
+        float pitch;            // 弧度，向上为正（已含重力与阻力补偿）
+        float flight_time;      // 秒
+        float distance;         // 水平距离 (m)
+        bool valid;
+
+        AimAngles() : yaw(0.0f), pitch(0.0f), flight_time(0.0f), distance(0.0f), valid(false) {}
+    };
+
+    // 由装甲板检测结果计算瞄准角：针孔模型估计目标位置，弹道查表补偿
+    class Aimer {
+    public:
+        Aimer();
+
+        // 相机内参，通常取写端由bundle标定发布的内参（DetectionReader::camera）
+        void setCamera(const ShmCamera& camera);
+        bool hasCamera() const { return has_camera_; }
+
+        // 设置弹道参数并重建查找表
+        void setBallistics(const BallisticParams& params, int distance_steps = 128, int height_steps = 64);
+
+        // 计算瞄准角；未设置相机内参时无效，超出查表范围时回退到迭代解算
+        AimAngles aim(const ShmArmor& armor) const;
+
+        const BallisticTable& table() const { return table_; }
+
+    private:
+        ShmCamera camera_;
+        bool has_camera_;
+        BallisticTable table_;
+    };
+
+} // namespace AutoAim
+
+#endif // AIMER_HPP
\ No newline at end of file
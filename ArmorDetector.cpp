@@ -1,9 +1,25 @@
 #include "ArmorDetector.hpp"
 #include <algorithm>
 #include <cmath>
+#include <iostream>
 
 namespace AutoAim {
 
+    void LightBarSoA::assign(const std::vector<cv::RotatedRect>& bars) {
+        const size_t n = bars.size();
+        x.resize(n);
+        y.resize(n);
+        angle.resize(n);
+        height.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = bars[i].center.x;
+            y[i] = bars[i].center.y;
+            float a = std::abs(bars[i].angle);
+            angle[i] = a > 90 ? 180 - a : a;
+            height[i] = bars[i].size.height;
+        }
+    }
+
     ArmorDetector::ArmorDetector()
         : max_height_ratio_(2.0),
         max_angle_diff_(20.0),
@@ -15,59 +31,192 @@ namespace AutoAim {
         light_detector_ = detector;
     }
 
+    void ArmorDetector::setColorThreshold(int saturation_thresh, int value_thresh) {
+        light_detector_.setColorThreshold(saturation_thresh, value_thresh);
+    }
+
+    void ArmorDetector::setYUVThreshold(int luma_thresh, int chroma_thresh) {
+        light_detector_.setYUVThreshold(luma_thresh, chroma_thresh);
+    }
+
+    void ArmorDetector::setPairThreshold(float max_height_ratio, float max_angle_diff,
+        float min_distance_ratio, float max_distance_ratio) {
+        // Ե÷ (max_height_ratio - 1)  max_angle_diff һ0ʱ÷ΪNaN/
+        // ȽϲϸȡȽͬʱܾNaN
+        if (!(max_height_ratio > 1.0f) || !(max_angle_diff > 0.0f) ||
+            !(min_distance_ratio >= 0.0f) || !(max_distance_ratio >= min_distance_ratio)) {
+            std::cerr << ": ֵЧ max_height_ratio > 1max_angle_diff > 0"
+                "0 <= min_distance_ratio <= max_distance_ratioԭֵ" << std::endl;
+            return;
+        }
+        max_height_ratio_ = max_height_ratio;
+        max_angle_diff_ = max_angle_diff;
+        min_distance_ratio_ = min_distance_ratio;
+        max_distance_ratio_ = max_distance_ratio;
+    }
+
     std::vector<Armor> ArmorDetector::detect(const cv::Mat& frame) {
+        return detect(frame, PixelFormat::BGR);
+    }
+
+    std::vector<Armor> ArmorDetector::detect(const cv::Mat& frame, PixelFormat format,
+        DetectionTrace* trace) {
+        std::vector<Armor> armors;
+        detect(frame, format, armors, trace);
+        return armors;
+    }
+
+    void ArmorDetector::detect(const cv::Mat& frame, PixelFormat format, std::vector<Armor>& armors,
+        DetectionTrace* trace) {
+        armors.clear();
+        if (light_detector_.isDualColor()) {
+            detectDualColor(frame, format, armors, trace);
+            return;
+        }
+
         // 
-        std::vector<cv::RotatedRect> light_bars = light_detector_.detect(frame);
+        std::vector<cv::RotatedRect> light_bars = light_detector_.detect(frame, format,
+            trace ? &trace->binary : nullptr, trace ? &trace->mask : nullptr);
+        if (trace != nullptr) {
+            trace->light_bars = light_bars;
+        }
+
+        // ԣɸѡʱɣ
+        pairLightBars(light_bars, armors);
+    }
 
-        // 
-        std::vector<Armor> armors = pairLightBars(light_bars);
+    std::vector<Armor> ArmorDetector::detectStream(RowStreamSource& source, const cv::Mat& frame,
+        PixelFormat format, DetectionTrace* trace) {
+        if (light_detector_.isDualColor()) {
+            while (source.waitRows() < frame.rows) {
+            }
+            std::vector<Armor> armors;
+            detectDualColor(frame, format, armors, trace);
+            return armors;
+        }
 
-        // ɸѡװװ
-        return filterArmors(armors);
+        std::vector<cv::RotatedRect> light_bars;
+        light_detector_.beginStream(Utils::frameSize(frame, format), format);
+        int rows = 0;
+        while (rows < frame.rows) {
+            rows = source.waitRows();
+            light_detector_.pushRows(frame, rows, light_bars);
+        }
+        if (trace != nullptr) {
+            trace->mask = light_detector_.streamMask();
+            trace->light_bars = light_bars;
+        }
+
+        std::vector<Armor> armors;
+        pairLightBars(light_bars, armors);
+        return armors;
+    }
+
+    void ArmorDetector::detectDualColor(const cv::Mat& frame, PixelFormat format,
+        std::vector<Armor>& armors, DetectionTrace* trace) {
+        std::vector<ColoredLightBar> light_bars = light_detector_.detectColored(frame, format,
+            trace ? &trace->binary : nullptr);
+
+        // ɫ飬ֻͬɫ֮ԣ黺֡ã
+        std::vector<cv::RotatedRect>& red_bars = red_bars_;
+        std::vector<cv::RotatedRect>& blue_bars = blue_bars_;
+        red_bars.clear();
+        blue_bars.clear();
+        for (const auto& bar : light_bars) {
+            (bar.color == LightColor::RED ? red_bars : blue_bars).push_back(bar.rect);
+            if (trace != nullptr) {
+                trace->light_bars.push_back(bar.rect);
+            }
+        }
+
+        pairLightBars(red_bars, armors);
+        const size_t red_count = armors.size();
+        pairLightBars(blue_bars, armors);
+        for (size_t i = 0; i < armors.size(); ++i) {
+            armors[i].color = i < red_count ? LightColor::RED : LightColor::BLUE;
+        }
     }
 
     std::vector<Armor> ArmorDetector::pairLightBars(const std::vector<cv::RotatedRect>& light_bars) {
         std::vector<Armor> armors;
+        pairLightBars(light_bars, armors);
+        return armors;
+    }
 
+    void ArmorDetector::pairLightBars(const std::vector<cv::RotatedRect>& light_bars,
+        std::vector<Armor>& armors) {
         if (light_bars.size() < 2) {
-            return armors;
+            return;
         }
 
-        // Եx
-        std::vector<cv::RotatedRect> sorted_bars = light_bars;
+        // Եx򣨻֡ã
+        std::vector<cv::RotatedRect>& sorted_bars = sorted_bars_;
+        sorted_bars.assign(light_bars.begin(), light_bars.end());
         std::sort(sorted_bars.begin(), sorted_bars.end(),
             [](const cv::RotatedRect& a, const cv::RotatedRect& b) {
                 return a.center.x < b.center.x;
             });
 
-        // ڵĵ
-        for (size_t i = 0; i < sorted_bars.size(); ++i) {
-            for (size_t j = i + 1; j < sorted_bars.size(); ++j) {
-                if (canPair(sorted_bars[i], sorted_bars[j])) {
-                    Armor armor;
-                    armor.left_light = sorted_bars[i];
-                    armor.right_light = sorted_bars[j];
-                    armor.bounding_rect = calculateArmorRect(sorted_bars[i], sorted_bars[j]);
-                    armor.is_large = isLargeArmor(armor);
-                    armors.push_back(armor);
+        // תΪṹ飬ÿҲеֻռͨ
+        std::vector<PairCandidate>& candidates = candidates_;
+        candidates.clear();
+        const size_t n = sorted_bars.size();
+        bar_soa_.assign(sorted_bars);
+        pair_accept_.resize(n);
+        pair_score_.resize(n);
+        for (size_t i = 0; i + 1 < n; ++i) {
+            evaluatePairs(bar_soa_, i, i + 1, n, pair_accept_.data(), pair_score_.data());
+            for (size_t j = i + 1; j < n; ++j) {
+                // ÷ΪNaN˻ĺѡ
+                float score = pair_score_[j - i - 1];
+                if (pair_accept_[j - i - 1] && score == score) {
+                    PairCandidate candidate;
+                    candidate.left = i;
+                    candidate.right = j;
+                    candidate.score = score;
+                    candidates.push_back(candidate);
                 }
             }
         }
 
-        return armors;
+        // ÷̰ķ䣬ʹõĵٲ
+        // ѡ (left, right) ռͬʱ±ȶͬҲҪʱ
+        std::sort(candidates.begin(), candidates.end(),
+            [](const PairCandidate& a, const PairCandidate& b) {
+                if (a.score != b.score) return a.score < b.score;
+                if (a.left != b.left) return a.left < b.left;
+                return a.right < b.right;
+            });
+
+        std::vector<uchar>& used = bar_used_;
+        used.assign(n, 0);
+        for (const auto& candidate : candidates) {
+            if (used[candidate.left] || used[candidate.right]) {
+                continue;
+            }
+
+            // ϸĺѡڷǰ޳ռõ
+            cv::Rect rect = calculateArmorRect(sorted_bars[candidate.left], sorted_bars[candidate.right]);
+            if (!isValidArmorRect(rect)) {
+                continue;
+            }
+            used[candidate.left] = 1;
+            used[candidate.right] = 1;
+
+            Armor armor;
+            armor.left_light = sorted_bars[candidate.left];
+            armor.right_light = sorted_bars[candidate.right];
+            armor.bounding_rect = rect;
+            armor.is_large = isLargeArmor(armor);
+            armors.push_back(armor);
+        }
     }
 
     std::vector<Armor> ArmorDetector::filterArmors(const std::vector<Armor>& armors) {
         std::vector<Armor> filtered;
 
         for (const auto& armor : armors) {
-            // ˹Сװװ
-            if (armor.bounding_rect.area() < 100) {
-                continue;
-            }
-
-            // ˹װװ
-            if (armor.bounding_rect.area() > 10000) {
+            if (!isValidArmorRect(armor.bounding_rect)) {
                 continue;
             }
 
@@ -77,45 +226,49 @@ namespace AutoAim {
         return filtered;
     }
 
-    bool ArmorDetector::canPair(const cv::RotatedRect& left, const cv::RotatedRect& right) {
-        // ߶ȱ
-        float left_height = left.size.height;
-        float right_height = right.size.height;
-        float height_ratio = std::max(left_height, right_height) /
-            std::min(left_height, right_height);
-
-        if (height_ratio > max_height_ratio_) {
-            return false;
-        }
-
-        // ǶȲ
-        float left_angle = std::abs(left.angle);
-        float right_angle = std::abs(right.angle);
-
-        if (left_angle > 90) left_angle = 180 - left_angle;
-        if (right_angle > 90) right_angle = 180 - right_angle;
-
-        float angle_diff = std::abs(left_angle - right_angle);
-        if (angle_diff > max_angle_diff_) {
-            return false;
-        }
-
-        // ͸߶ȱ
-        float avg_height = (left_height + right_height) / 2.0;
-        float distance = std::abs(right.center.x - left.center.x);
-        float distance_ratio = distance / avg_height;
-
-        if (distance_ratio < min_distance_ratio_ || distance_ratio > max_distance_ratio_) {
-            return false;
-        }
+    bool ArmorDetector::isValidArmorRect(const cv::Rect& rect) {
+        // ˹С͹װװ
+        return rect.area() >= 100 && rect.area() <= 10000;
+    }
 
-        // y
-        float y_diff = std::abs(right.center.y - left.center.y);
-        if (y_diff > avg_height) {
-            return false;
+    void ArmorDetector::evaluatePairs(const LightBarSoA& bars, size_t left, size_t first, size_t last,
+        uchar* accept, float* score) const {
+        const float lx = bars.x[left];
+        const float ly = bars.y[left];
+        const float la = bars.angle[left];
+        const float lh = bars.height[left];
+        const float* xs = bars.x.data() + first;
+        const float* ys = bars.y.data() + first;
+        const float* as = bars.angle.data() + first;
+        const float* hs = bars.height.data() + first;
+
+        const float max_height_ratio = max_height_ratio_;
+        const float max_angle_diff = max_angle_diff_;
+        const float min_distance_ratio = min_distance_ratio_;
+        const float max_distance_ratio = max_distance_ratio_;
+        const float height_norm = max_height_ratio_ - 1.0f;
+        const int count = static_cast<int>(last - first);
+
+        // ֵһͣı׼ֵСװԼ2.5װԼ4.5Ƚ
+        // Բοʵֵһ pair_bench 
+        for (int k = 0; k < count; ++k) {
+            float rh = hs[k];
+            float height_ratio = std::max(lh, rh) / std::min(lh, rh);
+            float angle_diff = std::abs(la - as[k]);
+            float avg_height = (lh + rh) / 2.0f;
+            float distance_ratio = std::abs(xs[k] - lx) / avg_height;
+            float y_ratio = std::abs(ys[k] - ly) / avg_height;
+
+            // ߶ȱȡǶȲȡyƫƾֵڣȡȽϣǰصдȼ
+            bool ok = !(height_ratio > max_height_ratio) & !(angle_diff > max_angle_diff) &
+                !(distance_ratio < min_distance_ratio) & !(distance_ratio > max_distance_ratio) &
+                !(y_ratio > 1.0f);
+            accept[k] = ok ? 1 : 0;
+
+            float nominal = distance_ratio > 3.5f ? 4.5f : 2.5f;
+            score[k] = (height_ratio - 1.0f) / height_norm + angle_diff / max_angle_diff + y_ratio +
+                std::abs(distance_ratio - nominal) / nominal;
         }
-
-        return true;
     }
 
     cv::Rect ArmorDetector::calculateArmorRect(const cv::RotatedRect& left,
@@ -140,11 +293,9 @@ namespace AutoAim {
         y1 -= height * expand / 2;
         y2 += height * expand / 2;
 
-        // ȷͼΧ
+        // ±߽ضϵ0±߽ͼߴйأʹ÷ͼ
         x1 = std::max(0.0f, x1);
         y1 = std::max(0.0f, y1);
-        x2 = std::min(1920.0f, x2);  // 
-        y2 = std::min(1080.0f, y2);  // ߶
 
         return cv::Rect(x1, y1, x2 - x1, y2 - y1);
     }
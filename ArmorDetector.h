@@ -4,9 +4,29 @@
 #include <opencv2/opencv.hpp>
 #include <vector>
 #include "Utils.hpp"
+#include "LightBarDetector.hpp"
+#include "RowStream.hpp"
 
 namespace AutoAim {
 
+    // Ľṹʽʱȡ
+    struct LightBarSoA {
+        std::vector<float> x;           // x
+        std::vector<float> y;           // y
+        std::vector<float> angle;       // һ[0, 90]ĽǶ
+        std::vector<float> height;      // ߶
+
+        void assign(const std::vector<cv::RotatedRect>& bars);
+        size_t size() const { return x.size(); }
+    };
+
+    // мعã
+    struct DetectionTrace {
+        cv::Mat binary;                             // ָ루·
+        RunMask mask;                               // ָ루ϡ衢ʽ·ʱ binary Ϊ
+        std::vector<cv::RotatedRect> light_bars;    // б
+    };
+
     class ArmorDetector {
     public:
         ArmorDetector();
@@ -14,18 +34,55 @@ namespace AutoAim {
         // õ
         void setLightBarDetector(const LightBarDetector& detector);
 
+        // õɫֵָӦģʽÿ֡ã
+        void setColorThreshold(int saturation_thresh, int value_thresh);
+
+        // YUV·ֵָӦģʽÿ֡ã
+        void setYUVThreshold(int luma_thresh, int chroma_thresh);
+        int yuvChromaThreshold() const { return light_detector_.yuvChromaThreshold(); }
+
+        // ֵ max_height_ratio > 1max_angle_diff > 00 <= С <= ȣԭֵ
+        void setPairThreshold(float max_height_ratio, float max_angle_diff,
+            float min_distance_ratio, float max_distance_ratio);
+
         // װװ
         std::vector<Armor> detect(const cv::Mat& frame);
 
-        // 
+        // װװ壨ԭYUV룩trace ǿʱ¼м
+        std::vector<Armor> detect(const cv::Mat& frame, PixelFormat format,
+            DetectionTrace* trace = nullptr);
+
+        // ͬϣд÷õ armorsգÿ֡
+        void detect(const cv::Mat& frame, PixelFormat format, std::vector<Armor>& armors,
+            DetectionTrace* trace = nullptr);
+
+        // ʽ⣺frame Ϊ source дĻ߽ձȡ
+        // ֻ֡ʣԣ˫ɫģʽ֡󰴳·
+        // trace ¼ʽõг̱룬عϣ֡·ɱȣ֧ģʽ
+        std::vector<Armor> detectStream(RowStreamSource& source, const cv::Mat& frame,
+            PixelFormat format, DetectionTrace* trace = nullptr);
+
+        // ԣ÷ȫ̰ķ䣬ÿһװװ
         std::vector<Armor> pairLightBars(const std::vector<cv::RotatedRect>& light_bars);
 
         // ɸѡװװ
         std::vector<Armor> filterArmors(const std::vector<Armor>& armors);
 
     private:
-        // жǷ
-        bool canPair(const cv::RotatedRect& left, const cv::RotatedRect& right);
+        // ˫ɫ⣺һηָͬɫԣװװɫ
+        void detectDualColor(const cv::Mat& frame, PixelFormat format, std::vector<Armor>& armors,
+            DetectionTrace* trace);
+
+        // Խ׷ӵ armors޳ϸĺѡپ filterArmors
+        void pairLightBars(const std::vector<cv::RotatedRect>& light_bars, std::vector<Armor>& armors);
+
+        //  left  [first, last) ԣ޷֧мɱ
+        // accept[k] Ϊ1ʾ first+k ֮ԣscore[k] ΪӦ÷֣ԽСԽã
+        void evaluatePairs(const LightBarSoA& bars, size_t left, size_t first, size_t last,
+            uchar* accept, float* score) const;
+
+        // װװǷںΧ
+        static bool isValidArmorRect(const cv::Rect& rect);
 
         // װװ
         cv::Rect calculateArmorRect(const cv::RotatedRect& left, const cv::RotatedRect& right);
@@ -39,6 +96,22 @@ namespace AutoAim {
         float max_angle_diff_;          // ǶȲ
         float max_distance_ratio_;      // 
         float min_distance_ratio_;      // С
+        // Ժѡ
+        struct PairCandidate {
+            size_t left;
+            size_t right;
+            float score;
+        };
+
+        // Ի֡ñÿ֡
+        std::vector<cv::RotatedRect> sorted_bars_;
+        LightBarSoA bar_soa_;
+        std::vector<uchar> pair_accept_;
+        std::vector<float> pair_score_;
+        std::vector<PairCandidate> candidates_;
+        std::vector<uchar> bar_used_;
+        std::vector<cv::RotatedRect> red_bars_;
+        std::vector<cv::RotatedRect> blue_bars_;
     };
 
 } // namespace AutoAim
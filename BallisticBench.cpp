@@ -0,0 +1,122 @@
+﻿// 弹道查找表精度与尺寸测试：与迭代解算逐点对比
+// 用法: ballistic_bench [--samples N] [--speed 弹速] [--drag 阻力系数]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "Ballistics.hpp"
+
+using namespace AutoAim;
+
+namespace {
+
+    struct Target {
+        float distance;
+        float height;
+        AimSolution reference;
+    };
+
+    double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+}
+
+int main(int argc, char** argv) {
+    int samples = 20000;
+    BallisticParams params;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--samples" && i + 1 < argc) {
+            samples = std::atoi(argv[++i]);
+        }
+        else if (arg == "--speed" && i + 1 < argc) {
+            params.muzzle_speed = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (arg == "--drag" && i + 1 < argc) {
+            params.drag_k = static_cast<float>(std::atof(argv[++i]));
+        }
+        else {
+            std::printf("用法: ballistic_bench [--samples N] [--speed 弹速] [--drag 阻力系数]\n");
+            return 1;
+        }
+    }
+
+    const float min_distance = 0.5f, max_distance = 12.0f;
+    const float min_height = -2.0f, max_height = 3.0f;
+
+    // 参考值：迭代解算
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> distance_dist(min_distance, max_distance);
+    std::uniform_real_distribution<float> height_dist(min_height, max_height);
+    std::vector<Target> targets;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < samples; ++i) {
+        Target target;
+        target.distance = distance_dist(rng);
+        target.height = height_dist(rng);
+        target.reference = solveBallistic(params, target.distance, target.height);
+        if (target.reference.valid) {
+            targets.push_back(target);
+        }
+    }
+    double iterative_us = elapsedSeconds(start) * 1e6 / samples;
+
+    std::printf("弹速 %.1f m/s, 阻力 %.3f, 可达样本 %zu/%d, 迭代解算 %.2f us/次\n",
+        params.muzzle_speed, params.drag_k, targets.size(), samples, iterative_us);
+    std::printf("%10s %10s %10s %12s %12s %12s %10s %10s\n", "网格", "内存(KB)", "建表(ms)",
+        "仰角均差", "仰角最大差", "落点最大差", "时间最大差", "查表(ns)");
+
+    const int sizes[][2] = { { 16, 8 }, { 32, 16 }, { 64, 32 }, { 128, 64 }, { 256, 128 } };
+    for (const auto& size : sizes) {
+        BallisticTable table;
+        start = std::chrono::steady_clock::now();
+        table.build(params, min_distance, max_distance, min_height, max_height, size[0], size[1]);
+        double build_ms = elapsedSeconds(start) * 1e3;
+
+        double sum_error = 0.0, max_error = 0.0, max_impact = 0.0, max_time = 0.0;
+        int covered = 0;
+        for (const auto& target : targets) {
+            AimSolution s = table.lookup(target.distance, target.height);
+            if (!s.valid) {
+                continue;
+            }
+            ++covered;
+            double error = std::fabs(s.pitch - target.reference.pitch);
+            sum_error += error;
+            max_error = std::max(max_error, error);
+            max_impact = std::max(max_impact, error * target.distance);
+            max_time = std::max(max_time, static_cast<double>(std::fabs(s.flight_time - target.reference.flight_time)));
+        }
+
+        // 查表耗时
+        volatile float sink = 0.0f;
+        start = std::chrono::steady_clock::now();
+        const int rounds = 20;
+        for (int r = 0; r < rounds; ++r) {
+            for (const auto& target : targets) {
+                sink = sink + table.lookup(target.distance, target.height).pitch;
+            }
+        }
+        double lookup_ns = elapsedSeconds(start) * 1e9 / (static_cast<double>(rounds) * targets.size());
+
+        char grid[32];
+        std::snprintf(grid, sizeof(grid), "%dx%d", size[0], size[1]);
+        std::printf("%10s %10.1f %10.1f %9.3fmrad %9.3fmrad %10.1fmm %8.2fms %10.1f",
+            grid, table.memoryBytes() / 1024.0, build_ms,
+            covered ? sum_error / covered * 1e3 : 0.0, max_error * 1e3, max_impact * 1e3,
+            max_time * 1e3, lookup_ns);
+        if (covered < static_cast<int>(targets.size())) {
+            std::printf("  (覆盖 %d/%zu)", covered, targets.size());
+        }
+        std::printf("\n");
+    }
+
+    return 0;
+}
\ No newline at end of file
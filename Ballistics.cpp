@@ -0,0 +1,198 @@
+﻿#include "Ballistics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace AutoAim {
+
+    namespace {
+        const float kIntegrationStep = 0.0005f;     // 积分步长 (s)
+        const float kMaxFlightTime = 5.0f;
+        const float kTolerance = 0.001f;            // 落点高度误差 (m)
+        const int kMaxIterations = 20;
+
+        // 建表用的仰角扇面
+        const int kFanSize = 2048;
+        const float kFanMaxPitch = 1.45f;           // 约83度，覆盖近距离大高差
+
+        float fanPitch(int k) {
+            return -kFanMaxPitch + 2.0f * kFanMaxPitch * k / (kFanSize - 1);
+        }
+
+        // 以仰角 pitch 发射，积分到水平距离 distance，输出该处高度与时间
+        bool simulate(const BallisticParams& params, float pitch, float distance,
+            float& height, float& time) {
+            float x = 0.0f, y = 0.0f;
+            float vx = params.muzzle_speed * std::cos(pitch);
+            float vy = params.muzzle_speed * std::sin(pitch);
+            float t = 0.0f;
+
+            while (t < kMaxFlightTime && vx > 0.0f) {
+                float v = std::sqrt(vx * vx + vy * vy);
+                float ax = -params.drag_k * v * vx;
+                float ay = -params.gravity - params.drag_k * v * vy;
+
+                float nvx = vx + ax * kIntegrationStep;
+                float nvy = vy + ay * kIntegrationStep;
+                float nx = x + nvx * kIntegrationStep;
+                float ny = y + nvy * kIntegrationStep;
+
+                if (nx >= distance) {
+                    // 在步内线性插值到目标距离
+                    float s = (distance - x) / (nx - x);
+                    height = y + (ny - y) * s;
+                    time = t + kIntegrationStep * s;
+                    return true;
+                }
+
+                x = nx;
+                y = ny;
+                vx = nvx;
+                vy = nvy;
+                t += kIntegrationStep;
+            }
+            return false;
+        }
+    }
+
+    AimSolution solveBallistic(const BallisticParams& params, float distance, float height) {
+        AimSolution solution;
+        if (distance <= 0.0f) {
+            return solution;
+        }
+
+        // 抬高瞄准点，直到弹道经过目标
+        float aim_height = height;
+        for (int i = 0; i < kMaxIterations; ++i) {
+            float pitch = std::atan2(aim_height, distance);
+            float hit_height, time;
+            if (!simulate(params, pitch, distance, hit_height, time)) {
+                return solution;
+            }
+
+            float error = height - hit_height;
+            if (std::fabs(error) < kTolerance) {
+                solution.pitch = pitch;
+                solution.flight_time = time;
+                solution.valid = true;
+                return solution;
+            }
+            aim_height += error;
+        }
+
+        return solution;
+    }
+
+    BallisticTable::BallisticTable()
+        : min_distance_(0.0f), min_height_(0.0f), distance_step_(1.0f), height_step_(1.0f),
+        distance_steps_(0), height_steps_(0) {
+    }
+
+    void BallisticTable::build(const BallisticParams& params, float min_distance, float max_distance,
+        float min_height, float max_height, int distance_steps, int height_steps) {
+        if (distance_steps < 2 || height_steps < 2) {
+            return;
+        }
+
+        params_ = params;
+        min_distance_ = min_distance;
+        min_height_ = min_height;
+        distance_steps_ = distance_steps;
+        height_steps_ = height_steps;
+        distance_step_ = (max_distance - min_distance) / (distance_steps - 1);
+        height_step_ = (max_height - min_height) / (height_steps - 1);
+
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        pitch_.assign(static_cast<size_t>(distance_steps) * height_steps, nan);
+        flight_time_.assign(pitch_.size(), nan);
+
+        // 一组仰角各积分一条弹道，记录经过每个距离列时的高度与时间
+        // 建表代价与网格大小基本无关
+        std::vector<float> fan_height(static_cast<size_t>(kFanSize) * distance_steps, nan);
+        std::vector<float> fan_time(fan_height.size(), nan);
+        for (int k = 0; k < kFanSize; ++k) {
+            float pitch = fanPitch(k);
+            float x = 0.0f, y = 0.0f, t = 0.0f;
+            float vx = params.muzzle_speed * std::cos(pitch);
+            float vy = params.muzzle_speed * std::sin(pitch);
+            int d = 0;
+
+            while (d < distance_steps && t < kMaxFlightTime && vx > 0.0f) {
+                float v = std::sqrt(vx * vx + vy * vy);
+                float nvx = vx - params.drag_k * v * vx * kIntegrationStep;
+                float nvy = vy - (params.gravity + params.drag_k * v * vy) * kIntegrationStep;
+                float nx = x + nvx * kIntegrationStep;
+                float ny = y + nvy * kIntegrationStep;
+
+                for (float column = min_distance + d * distance_step_; d < distance_steps && nx >= column;
+                    column = min_distance + (++d) * distance_step_) {
+                    float s = (column - x) / (nx - x);
+                    fan_height[static_cast<size_t>(k) * distance_steps + d] = y + (ny - y) * s;
+                    fan_time[static_cast<size_t>(k) * distance_steps + d] = t + kIntegrationStep * s;
+                }
+
+                x = nx;
+                y = ny;
+                vx = nvx;
+                vy = nvy;
+                t += kIntegrationStep;
+            }
+        }
+
+        // 每个距离列上，低弹道段的高度随仰角单调递增，取第一个跨过目标高度的区间插值
+        for (int d = 0; d < distance_steps; ++d) {
+            int start = 0;
+            for (int h = 0; h < height_steps; ++h) {
+                float height = min_height + h * height_step_;
+                for (int k = start; k + 1 < kFanSize; ++k) {
+                    float a = fan_height[static_cast<size_t>(k) * distance_steps + d];
+                    float b = fan_height[static_cast<size_t>(k + 1) * distance_steps + d];
+                    if (a <= height && height <= b) {
+                        float s = b > a ? (height - a) / (b - a) : 0.0f;
+                        float ta = fan_time[static_cast<size_t>(k) * distance_steps + d];
+                        float tb = fan_time[static_cast<size_t>(k + 1) * distance_steps + d];
+                        pitch_[h * distance_steps + d] = fanPitch(k) + (fanPitch(k + 1) - fanPitch(k)) * s;
+                        flight_time_[h * distance_steps + d] = ta + (tb - ta) * s;
+                        start = k;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    AimSolution BallisticTable::lookup(float distance, float height) const {
+        AimSolution solution;
+
+        float fd = (distance - min_distance_) / distance_step_;
+        float fh = (height - min_height_) / height_step_;
+        if (!(fd >= 0.0f && fh >= 0.0f && fd <= distance_steps_ - 1 && fh <= height_steps_ - 1)) {
+            return solution;
+        }
+
+        // 落在最后一格边界上时取前一格
+        int d0 = std::min(static_cast<int>(fd), distance_steps_ - 2);
+        int h0 = std::min(static_cast<int>(fh), height_steps_ - 2);
+        float sd = fd - d0;
+        float sh = fh - h0;
+
+        size_t i00 = static_cast<size_t>(h0) * distance_steps_ + d0;
+        size_t i10 = i00 + distance_steps_;
+
+        float p = (pitch_[i00] * (1 - sd) + pitch_[i00 + 1] * sd) * (1 - sh)
+            + (pitch_[i10] * (1 - sd) + pitch_[i10 + 1] * sd) * sh;
+        float t = (flight_time_[i00] * (1 - sd) + flight_time_[i00 + 1] * sd) * (1 - sh)
+            + (flight_time_[i10] * (1 - sd) + flight_time_[i10 + 1] * sd) * sh;
+
+        // 任一邻近网格点不可达时插值结果为NaN
+        if (p != p || t != t) {
+            return solution;
+        }
+
+        solution.pitch = p;
+        solution.flight_time = t;
+        solution.valid = true;
+        return solution;
+    }
+
+} // namespace AutoAim
\ No newline at end of file
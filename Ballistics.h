@@ -0,0 +1,65 @@
+﻿#ifndef BALLISTICS_HPP
+#define BALLISTICS_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 弹道解算：二次空气阻力 + 重力
+// 迭代解算作为参考实现，查表用于每帧多目标的常数时间解算
+// 不依赖OpenCV
+
+namespace AutoAim {
+
+    struct BallisticParams {
+        float muzzle_speed;     // 弹速 (m/s)
+        float drag_k;           // 阻力系数 k，a = -k|v|v (1/m)
+        float gravity;          // (m/s^2)
+
+        BallisticParams() : muzzle_speed(15.0f), drag_k(0.02f), gravity(9.81f) {}
+    };
+
+    // 解算结果：枪管仰角与飞行时间
+    struct AimSolution {
+        float pitch;            // 弧度，向上为正
+        float flight_time;      // 秒
+        bool valid;             // 目标不可达时为false
+
+        AimSolution() : pitch(0.0f), flight_time(0.0f), valid(false) {}
+    };
+
+    // 迭代解算：数值积分弹道，按落点高度误差修正瞄准点
+    // distance 为水平距离，height 为目标相对枪口高度（向上为正），单位米
+    AimSolution solveBallistic(const BallisticParams& params, float distance, float height);
+
+    // 距离 x 高度二维查找表，双线性插值
+    class BallisticTable {
+    public:
+        BallisticTable();
+
+        // 积分一组仰角的弹道后按网格反查（启动时调用）
+        void build(const BallisticParams& params, float min_distance, float max_distance,
+            float min_height, float max_height, int distance_steps, int height_steps);
+
+        // 常数时间查表；超出范围或邻近网格点不可达时返回无效
+        AimSolution lookup(float distance, float height) const;
+
+        bool isBuilt() const { return !pitch_.empty(); }
+        const BallisticParams& params() const { return params_; }
+        size_t memoryBytes() const { return (pitch_.size() + flight_time_.size()) * sizeof(float); }
+
+    private:
+        BallisticParams params_;
+        float min_distance_;
+        float min_height_;
+        float distance_step_;
+        float height_step_;
+        int distance_steps_;
+        int height_steps_;
+        std::vector<float> pitch_;          // 行主序：height x distance，不可达为NaN
+        std::vector<float> flight_time_;
+    };
+
+} // namespace AutoAim
+
+#endif // BALLISTICS_HPP
\ No newline at end of file
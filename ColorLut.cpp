@@ -0,0 +1,175 @@
+﻿#include "ColorLut.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace AutoAim {
+
+    namespace {
+        const char kLutMagic[4] = { 'A', 'A', 'C', 'L' };
+        const uint32_t kLutVersion = 1;
+
+        struct LutHeader {
+            char magic[4];
+            uint32_t version;
+            uint32_t bits;
+            uint32_t table_size;
+        };
+    }
+
+    ColorLut::ColorLut(int bits)
+        : bits_(bits), table_((static_cast<size_t>(1) << (3 * bits)) / 4, 0) {
+        buildChannelIndex();
+    }
+
+    void ColorLut::buildChannelIndex() {
+        channel_index_.resize(3 * 256);
+        for (int v = 0; v < 256; ++v) {
+            channel_index_[v] = static_cast<uint32_t>(cellIndex(v, 0, 0));
+            channel_index_[256 + v] = static_cast<uint32_t>(cellIndex(0, v, 0));
+            channel_index_[512 + v] = static_cast<uint32_t>(cellIndex(0, 0, v));
+        }
+    }
+
+    ColorLut ColorLut::fromHSV(int saturation_min, int value_min, int bits) {
+        ColorLut lut(bits);
+
+        // 每格取中心颜色，整体做一次HSV转换
+        const int cells = lut.cellCount();
+        const int half = 1 << (7 - bits);
+        cv::Mat centers(1, cells, CV_8UC3);
+        uchar* p = centers.ptr<uchar>(0);
+        for (int b = 0; b < (1 << bits); ++b) {
+            for (int g = 0; g < (1 << bits); ++g) {
+                for (int r = 0; r < (1 << bits); ++r, p += 3) {
+                    p[0] = static_cast<uchar>((b << (8 - bits)) + half);
+                    p[1] = static_cast<uchar>((g << (8 - bits)) + half);
+                    p[2] = static_cast<uchar>((r << (8 - bits)) + half);
+                }
+            }
+        }
+
+        cv::Mat hsv;
+        cv::cvtColor(centers, hsv, cv::COLOR_BGR2HSV);
+        const uchar* q = hsv.ptr<uchar>(0);
+        for (int cell = 0; cell < cells; ++cell, q += 3) {
+            if (q[1] < saturation_min || q[2] < value_min) continue;
+            if (q[0] <= 10 || q[0] >= 160) {
+                lut.setCellClass(cell, static_cast<uchar>(LightColor::RED));
+            }
+            else if (q[0] >= 100 && q[0] <= 130) {
+                lut.setCellClass(cell, static_cast<uchar>(LightColor::BLUE));
+            }
+        }
+
+        return lut;
+    }
+
+    bool ColorLut::load(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        LutHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, kLutMagic, 4) != 0 || header.version != kLutVersion ||
+            header.bits < 4 || header.bits > 7 ||
+            header.table_size != (static_cast<uint32_t>(1) << (3 * header.bits)) / 4) {
+            std::cerr << "错误: 颜色查找表格式不匹配 " << path << std::endl;
+            return false;
+        }
+
+        std::vector<uchar> table(header.table_size);
+        if (!file.read(reinterpret_cast<char*>(table.data()), table.size())) {
+            std::cerr << "错误: 颜色查找表不完整 " << path << std::endl;
+            return false;
+        }
+
+        bits_ = static_cast<int>(header.bits);
+        table_.swap(table);
+        buildChannelIndex();
+        return true;
+    }
+
+    bool ColorLut::save(const std::string& path) const {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "错误: 无法创建颜色查找表 " << path << std::endl;
+            return false;
+        }
+
+        LutHeader header;
+        std::memcpy(header.magic, kLutMagic, 4);
+        header.version = kLutVersion;
+        header.bits = static_cast<uint32_t>(bits_);
+        header.table_size = static_cast<uint32_t>(table_.size());
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(table_.data()), table_.size());
+        return static_cast<bool>(file);
+    }
+
+    void ColorLut::classifyRow(const uchar* bgr, int width, LightColor target, uchar* dst) const {
+        const uint32_t* bi = channel_index_.data();
+        const uint32_t* gi = bi + 256;
+        const uint32_t* ri = bi + 512;
+        if (target == LightColor::NONE) {
+            for (int c = 0; c < width; ++c, bgr += 3) {
+                dst[c] = cellClass(static_cast<int>(bi[bgr[0]] | gi[bgr[1]] | ri[bgr[2]]));
+            }
+        }
+        else {
+            const uchar wanted = static_cast<uchar>(target);
+            for (int c = 0; c < width; ++c, bgr += 3) {
+                dst[c] = cellClass(static_cast<int>(bi[bgr[0]] | gi[bgr[1]] | ri[bgr[2]])) == wanted ? 255 : 0;
+            }
+        }
+    }
+
+    cv::Mat ColorLut::segment(const cv::Mat& bgr, LightColor target) const {
+        CV_Assert(bgr.type() == CV_8UC3);
+        cv::Mat out(bgr.rows, bgr.cols, CV_8UC1);
+        for (int r = 0; r < bgr.rows; ++r) {
+            classifyRow(bgr.ptr<uchar>(r), bgr.cols, target, out.ptr<uchar>(r));
+        }
+        return out;
+    }
+
+    ColorLutCalibrator::ColorLutCalibrator(int bits)
+        : bits_(bits), counts_((static_cast<size_t>(1) << (3 * bits)) * 3, 0), samples_(0) {
+    }
+
+    void ColorLutCalibrator::addSample(const cv::Mat& bgr, const cv::Mat& mask) {
+        CV_Assert(bgr.type() == CV_8UC3 && mask.type() == CV_8UC1 && bgr.size() == mask.size());
+
+        for (int r = 0; r < bgr.rows; ++r) {
+            const uchar* p = bgr.ptr<uchar>(r);
+            const uchar* m = mask.ptr<uchar>(r);
+            for (int c = 0; c < bgr.cols; ++c, p += 3) {
+                if (m[c] > 2) continue;
+                counts_[static_cast<size_t>(ColorLut::cellIndex(p[0], p[1], p[2], bits_)) * 3 + m[c]]++;
+                ++samples_;
+            }
+        }
+    }
+
+    bool ColorLutCalibrator::build(const ColorLut& fallback, ColorLut& lut, int min_samples) const {
+        if (fallback.bits() != bits_) {
+            std::cerr << "错误: 默认查找表为 " << fallback.bits() << " 位，与标定的 " << bits_
+                << " 位不一致" << std::endl;
+            return false;
+        }
+        lut = fallback;
+
+        for (int cell = 0; cell < lut.cellCount(); ++cell) {
+            const uint32_t* n = &counts_[static_cast<size_t>(cell) * 3];
+            if (static_cast<int>(n[0] + n[1] + n[2]) < min_samples) {
+                continue;
+            }
+            // 多数类别，平局时取背景
+            uchar label = 0;
+            if (n[1] > n[0] && n[1] >= n[2]) label = static_cast<uchar>(LightColor::RED);
+            else if (n[2] > n[0] && n[2] > n[1]) label = static_cast<uchar>(LightColor::BLUE);
+            lut.setCellClass(cell, label);
+        }
+
+        return true;
+    }
+
+} // namespace AutoAim
\ No newline at end of file
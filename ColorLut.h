@@ -0,0 +1,85 @@
+﻿#ifndef COLOR_LUT_HPP
+#define COLOR_LUT_HPP
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Utils.hpp"
+
+namespace AutoAim {
+
+    // BGR -> 类别（背景/红/蓝）查找表
+    // 每通道取高 bits 位，每格2位打包，6位时 64^3 格共 64KB
+    // 分割时每像素一次查表，不做HSV转换
+    class ColorLut {
+    public:
+        explicit ColorLut(int bits = 6);
+
+        // 由HSV阈值生成（与 LightBarDetector 的固定HSV范围一致），作为未标定格的默认值
+        static ColorLut fromHSV(int saturation_min, int value_min, int bits = 6);
+
+        bool load(const std::string& path);
+        bool save(const std::string& path) const;
+
+        int bits() const { return bits_; }
+        int cellCount() const { return 1 << (3 * bits_); }
+
+        // 格下标
+        int cellIndex(int b, int g, int r) const { return cellIndex(b, g, r, bits_); }
+
+        static int cellIndex(int b, int g, int r, int bits) {
+            const int shift = 8 - bits;
+            return ((b >> shift) << (2 * bits)) | ((g >> shift) << bits) | (r >> shift);
+        }
+
+        uchar cellClass(int cell) const {
+            return (table_[cell >> 2] >> ((cell & 3) * 2)) & 3;
+        }
+
+        void setCellClass(int cell, uchar label) {
+            uchar& byte = table_[cell >> 2];
+            const int shift = (cell & 3) * 2;
+            byte = static_cast<uchar>((byte & ~(3 << shift)) | ((label & 3) << shift));
+        }
+
+        uchar classify(int b, int g, int r) const { return cellClass(cellIndex(b, g, r)); }
+
+        // 分类一行BGR像素：target 为 NONE 时输出标签（0/1/2），否则输出该颜色的 0/255 掩码
+        void classifyRow(const uchar* bgr, int width, LightColor target, uchar* dst) const;
+
+        // 分类整帧
+        cv::Mat segment(const cv::Mat& bgr, LightColor target) const;
+
+    private:
+        // 按位数生成各通道的下标分量
+        void buildChannelIndex();
+
+    private:
+        int bits_;
+        std::vector<uchar> table_;
+        std::vector<uint32_t> channel_index_;   // B/G/R 各256项，三者相或即格下标，逐行分类时免去移位
+    };
+
+    // 离线标定：统计标注像素落在各格的类别次数，按多数生成查找表
+    class ColorLutCalibrator {
+    public:
+        explicit ColorLutCalibrator(int bits = 6);
+
+        // mask：0 背景，1 红色灯条，2 蓝色灯条，其他值忽略
+        void addSample(const cv::Mat& bgr, const cv::Mat& mask);
+
+        // 样本数不足 min_samples 的格沿用 fallback；fallback 的位数须与标定一致
+        bool build(const ColorLut& fallback, ColorLut& lut, int min_samples = 1) const;
+
+        uint64_t sampleCount() const { return samples_; }
+
+    private:
+        int bits_;
+        std::vector<uint32_t> counts_;  // 每格3个类别计数
+        uint64_t samples_;
+    };
+
+} // namespace AutoAim
+
+#endif // COLOR_LUT_HPP
\ No newline at end of file
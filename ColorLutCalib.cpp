@@ -0,0 +1,172 @@
+﻿// 颜色查找表标定工具：由标注样本生成 BGR->类别 查找表
+// 用法: color_lut_calib <输出文件> <图像> <掩码> [<图像> <掩码> ...]
+//       [--bits 6] [--min_samples 3] [--saturation 100] [--value 100] [--holdout 4]
+// 掩码为单通道PNG：0 背景，1 红色灯条，2 蓝色灯条，其他值忽略
+// 每 holdout 对样本留出一对不参与标定，只用于评估；输出的查找表使用全部样本
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "ColorLut.hpp"
+
+using namespace AutoAim;
+
+namespace {
+
+    // 在样本上统计误检（背景判为灯条）与漏检（灯条判错）
+    void evaluate(const char* name, const ColorLut& lut,
+        const std::vector<cv::Mat>& images, const std::vector<cv::Mat>& masks) {
+        uint64_t background = 0, lights = 0, false_positive = 0, missed = 0;
+        for (size_t i = 0; i < images.size(); ++i) {
+            for (int r = 0; r < images[i].rows; ++r) {
+                const uchar* p = images[i].ptr<uchar>(r);
+                const uchar* m = masks[i].ptr<uchar>(r);
+                for (int c = 0; c < images[i].cols; ++c, p += 3) {
+                    if (m[c] > 2) continue;
+                    uchar label = lut.classify(p[0], p[1], p[2]);
+                    if (m[c] == 0) {
+                        ++background;
+                        false_positive += label != 0;
+                    }
+                    else {
+                        ++lights;
+                        missed += label != m[c];
+                    }
+                }
+            }
+        }
+        std::printf("%-8s 误检 %llu/%llu (%.4f%%)  漏检 %llu/%llu (%.2f%%)\n", name,
+            static_cast<unsigned long long>(false_positive), static_cast<unsigned long long>(background),
+            background ? 100.0 * false_positive / background : 0.0,
+            static_cast<unsigned long long>(missed), static_cast<unsigned long long>(lights),
+            lights ? 100.0 * missed / lights : 0.0);
+    }
+
+    // 每百万像素的分割耗时（毫秒），重复多次取最快一次
+    template <typename Segment>
+    double timeSegment(const std::vector<cv::Mat>& images, Segment segment) {
+        const int repeats = 5;
+        double pixels = 0.0;
+        for (const auto& image : images) {
+            pixels += static_cast<double>(image.total());
+        }
+
+        double best = 0.0;
+        cv::Mat binary;
+        for (int k = 0; k < repeats; ++k) {
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& image : images) {
+                segment(image, binary);
+            }
+            double elapsed = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+            best = (k == 0) ? elapsed : std::min(best, elapsed);
+        }
+        return pixels > 0.0 ? best * 1e6 / pixels : 0.0;
+    }
+
+    void printUsage() {
+        std::cout << "用法: color_lut_calib <输出文件> <图像> <掩码> [<图像> <掩码> ...]" << std::endl;
+        std::cout << "      [--bits 6] [--min_samples 3] [--saturation 100] [--value 100] [--holdout 4]" << std::endl;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    int bits = 6, min_samples = 3, saturation = 100, value = 100, holdout = 4;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--bits" && i + 1 < argc) bits = std::atoi(argv[++i]);
+        else if (arg == "--min_samples" && i + 1 < argc) min_samples = std::atoi(argv[++i]);
+        else if (arg == "--saturation" && i + 1 < argc) saturation = std::atoi(argv[++i]);
+        else if (arg == "--value" && i + 1 < argc) value = std::atoi(argv[++i]);
+        else if (arg == "--holdout" && i + 1 < argc) holdout = std::atoi(argv[++i]);
+        else if (arg.compare(0, 2, "--") == 0) {
+            std::cerr << "错误: 未知选项或缺少参数 " << arg << std::endl;
+            printUsage();
+            return 1;
+        }
+        else paths.push_back(arg);
+    }
+
+    if (paths.size() < 3 || paths.size() % 2 != 1 || bits < 4 || bits > 7 || holdout < 0) {
+        printUsage();
+        return 1;
+    }
+
+    // 标定集与留出集分开统计，另一份计数使用全部样本生成最终查找表
+    ColorLutCalibrator train_calibrator(bits), full_calibrator(bits);
+    std::vector<cv::Mat> train_images, train_masks, test_images, test_masks;
+    for (size_t i = 1; i + 1 < paths.size(); i += 2) {
+        cv::Mat image = cv::imread(paths[i], cv::IMREAD_COLOR);
+        cv::Mat mask = cv::imread(paths[i + 1], cv::IMREAD_GRAYSCALE);
+        if (image.empty() || mask.empty() || image.size() != mask.size()) {
+            std::cerr << "错误: 无法读取样本或尺寸不一致 " << paths[i] << std::endl;
+            return 1;
+        }
+
+        // 与 LightBarDetector::preprocess 相同的模糊，标定与检测看到的颜色一致
+        cv::GaussianBlur(image, image, cv::Size(5, 5), 0);
+        full_calibrator.addSample(image, mask);
+
+        const size_t pair = (i - 1) / 2;
+        if (holdout > 0 && pair % holdout == static_cast<size_t>(holdout - 1)) {
+            test_images.push_back(image);
+            test_masks.push_back(mask);
+        }
+        else {
+            train_calibrator.addSample(image, mask);
+            train_images.push_back(image);
+            train_masks.push_back(mask);
+        }
+    }
+
+    ColorLut fallback = ColorLut::fromHSV(saturation, value, bits);
+    ColorLut train_lut(bits), lut(bits);
+    if (!train_calibrator.build(fallback, train_lut, min_samples) ||
+        !full_calibrator.build(fallback, lut, min_samples)) {
+        return 1;
+    }
+
+    std::cout << "标注像素: " << full_calibrator.sampleCount() << "（标定 " << train_calibrator.sampleCount()
+        << "，留出 " << test_images.size() << " 对样本）" << std::endl;
+    std::cout << "标定集:" << std::endl;
+    evaluate("HSV", fallback, train_images, train_masks);
+    evaluate("查找表", train_lut, train_images, train_masks);
+    if (test_images.empty()) {
+        std::cout << "留出集为空（样本不足或 --holdout 0），上面的结果不代表泛化精度" << std::endl;
+    }
+    else {
+        std::cout << "留出集:" << std::endl;
+        evaluate("HSV", fallback, test_images, test_masks);
+        evaluate("查找表", train_lut, test_images, test_masks);
+    }
+
+    // 与检测时相同的单色分割：HSV 为颜色转换 + 阈值，查找表为逐像素查表
+    std::vector<cv::Mat> all_images(train_images);
+    all_images.insert(all_images.end(), test_images.begin(), test_images.end());
+    double hsv_ms = timeSegment(all_images, [&](const cv::Mat& image, cv::Mat& binary) {
+        cv::Mat hsv, red1, red2;
+        cv::cvtColor(image, hsv, cv::COLOR_BGR2HSV);
+        cv::inRange(hsv, cv::Scalar(0, saturation, value), cv::Scalar(10, 255, 255), red1);
+        cv::inRange(hsv, cv::Scalar(160, saturation, value), cv::Scalar(180, 255, 255), red2);
+        binary = red1 | red2;
+    });
+    double lut_ms = timeSegment(all_images, [&](const cv::Mat& image, cv::Mat& binary) {
+        binary = lut.segment(image, LightColor::RED);
+    });
+    std::printf("分割耗时: HSV %.3f ms/MP，查找表 %.3f ms/MP\n", hsv_ms, lut_ms);
+
+    if (!lut.save(paths[0])) {
+        return 1;
+    }
+    std::cout << "颜色查找表已保存: " << paths[0] << std::endl;
+    return 0;
+}
\ No newline at end of file
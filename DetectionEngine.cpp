@@ -0,0 +1,120 @@
+﻿#include "DetectionEngine.hpp"
+#include "ArmorDetector.hpp"
+#include "NumberRecognizer.hpp"
+#include "ModelBundle.hpp"
+#include <algorithm>
+
+namespace AutoAim {
+
+    namespace {
+        void toShmLight(const cv::RotatedRect& rect, ShmLight& light) {
+            light.cx = rect.center.x;
+            light.cy = rect.center.y;
+            light.width = rect.size.width;
+            light.height = rect.size.height;
+            light.angle = rect.angle;
+        }
+
+        // 每个像素的字节数（NV12按Y平面计）
+        size_t bytesPerPixel(PixelFormat format) {
+            switch (format) {
+            case PixelFormat::BGR:
+                return 3;
+            case PixelFormat::YUYV:
+                return 2;
+            case PixelFormat::NV12:
+                return 1;
+            }
+            return 0;
+        }
+
+        // 将外部缓冲区包装为cv::Mat（不拷贝）
+        cv::Mat wrap(const ImageView& image) {
+            void* data = const_cast<uint8_t*>(image.data);
+            switch (image.format) {
+            case PixelFormat::BGR:
+                return cv::Mat(image.height, image.width, CV_8UC3, data, image.stride);
+            case PixelFormat::YUYV:
+                return cv::Mat(image.height, image.width, CV_8UC2, data, image.stride);
+            case PixelFormat::NV12:
+                // Y平面与UV平面按同一跨度连续存放
+                return cv::Mat(image.height * 3 / 2, image.width, CV_8UC1, data, image.stride);
+            }
+            return cv::Mat();
+        }
+    }
+
+    DetectionEngine::DetectionEngine(const std::string& enemy_color)
+        : enemy_color_(enemy_color),
+        bundle_(new ModelBundle()),
+        armor_detector_(new ArmorDetector()),
+        number_recognizer_(new NumberRecognizer(false)),
+        detected_(new std::vector<Armor>()) {
+        armor_detector_->setLightBarDetector(LightBarDetector(enemy_color));
+    }
+
+    DetectionEngine::~DetectionEngine() {
+    }
+
+    bool DetectionEngine::loadBundle(const std::string& path) {
+        // 先加载到新的bundle：失败时识别器仍引用旧映射，不能先释放
+        std::unique_ptr<ModelBundle> bundle(new ModelBundle());
+        if (!bundle->load(path)) {
+            return false;
+        }
+        LightBarDetector light_detector(enemy_color_);
+        bundle->apply(light_detector, *armor_detector_, *number_recognizer_);
+        armor_detector_->setLightBarDetector(light_detector);
+
+        // 识别器已换用新模板，旧映射可以释放
+        bundle_ = std::move(bundle);
+        return true;
+    }
+
+    bool DetectionEngine::loadTemplates(const std::string& directory) {
+        return number_recognizer_->loadTemplates(directory);
+    }
+
+    int DetectionEngine::detect(const ImageView& image, ShmArmor* armors, int capacity) {
+        if (capacity < 0 || (capacity > 0 && armors == nullptr)) {
+            return -1;
+        }
+        if (image.data == nullptr || image.width <= 0 || image.height <= 0 ||
+            image.stride < static_cast<size_t>(image.width) * bytesPerPixel(image.format) ||
+            (image.format == PixelFormat::NV12 && image.height % 2 != 0)) {
+            return -1;
+        }
+
+        cv::Mat frame = wrap(image);
+        if (frame.empty()) {
+            return -1;
+        }
+
+        std::vector<Armor>& detected = *detected_;
+        armor_detector_->detect(frame, image.format, detected);
+
+        int count = std::min(static_cast<int>(detected.size()), capacity);
+        for (int i = 0; i < count; ++i) {
+            Armor& armor = detected[i];
+            armor.number = number_recognizer_->recognizePatch(NumberRecognizer::extractNumberPatch(
+                frame, image.format, armor.left_light, armor.right_light), &armor.confidence);
+            toShmArmor(armor, armors[i]);
+        }
+
+        return static_cast<int>(detected.size());
+    }
+
+    void DetectionEngine::toShmArmor(const Armor& armor, ShmArmor& out) {
+        toShmLight(armor.left_light, out.left);
+        toShmLight(armor.right_light, out.right);
+        out.rect[0] = armor.bounding_rect.x;
+        out.rect[1] = armor.bounding_rect.y;
+        out.rect[2] = armor.bounding_rect.width;
+        out.rect[3] = armor.bounding_rect.height;
+        out.number = armor.number;
+        out.confidence = static_cast<float>(armor.confidence);
+        out.is_large = armor.is_large ? 1 : 0;
+        out.color = static_cast<int32_t>(armor.color);
+    }
+
+} // namespace AutoAim
\ No newline at end of file
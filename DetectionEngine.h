@@ -0,0 +1,74 @@
+﻿#ifndef DETECTION_ENGINE_HPP
+#define DETECTION_ENGINE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "PixelFormat.hpp"
+#include "DetectionShm.hpp"
+
+// 对外接口不包含OpenCV头文件，检测器只前置声明
+
+namespace AutoAim {
+
+    struct Armor;
+    class ArmorDetector;
+    class NumberRecognizer;
+    class ModelBundle;
+
+    // 调用方持有的图像内存，检测期间须保持有效
+    struct ImageView {
+        const uint8_t* data;
+        int width;
+        int height;
+        size_t stride;          // 行字节数；NV12的UV平面须紧接在Y平面之后（data + stride * height）
+        PixelFormat format;
+
+        ImageView() : data(nullptr), width(0), height(0), stride(0), format(PixelFormat::BGR) {}
+        ImageView(const uint8_t* data_, int width_, int height_, size_t stride_, PixelFormat format_)
+            : data(data_), width(width_), height(height_), stride(stride_), format(format_) {}
+    };
+
+    // 可嵌入的检测核心：不依赖highgui/videoio，由相机SDK进程直接调用
+    // 输入只包装为cv::Mat头，不拷贝像素；结果写入调用方数组（与共享内存布局相同）
+    class DetectionEngine {
+    public:
+        explicit DetectionEngine(const std::string& enemy_color = "red");
+        ~DetectionEngine();
+
+        // 从bundle加载参数与模板（模板引用映射内存）
+        // 加载失败时保持原有参数与模板不变
+        bool loadBundle(const std::string& path);
+
+        // 从模板目录加载数字模板
+        bool loadTemplates(const std::string& directory);
+
+        // 直接调整检测器参数
+        ArmorDetector& armorDetector() { return *armor_detector_; }
+        NumberRecognizer& numberRecognizer() { return *number_recognizer_; }
+
+        // 检测一帧，最多写入 capacity 个结果
+        // 返回检测到的装甲板总数（可能大于 capacity），输入无效（含 stride 小于行宽、
+        // capacity 为负、capacity > 0 而 armors 为空）时返回 -1
+        int detect(const ImageView& image, ShmArmor* armors, int capacity);
+
+        // 转换为共享内存/外部接口的结果格式
+        static void toShmArmor(const Armor& armor, ShmArmor& out);
+
+    private:
+        DetectionEngine(const DetectionEngine&);
+        DetectionEngine& operator=(const DetectionEngine&);
+
+    private:
+        std::string enemy_color_;
+        std::unique_ptr<ModelBundle> bundle_;   // 须先于识别器构造、后于其析构：模板引用其映射内存
+        std::unique_ptr<ArmorDetector> armor_detector_;
+        std::unique_ptr<NumberRecognizer> number_recognizer_;
+        std::unique_ptr<std::vector<Armor>> detected_;  // 检测结果缓冲区，跨帧复用（Armor 仅前置声明）
+    };
+
+} // namespace AutoAim
+
+#endif // DETECTION_ENGINE_HPP
\ No newline at end of file
@@ -0,0 +1,324 @@
+﻿#include "DetectionLog.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace AutoAim {
+
+    namespace {
+        const char kLogMagic[4] = { 'A', 'A', 'D', 'L' };
+        const char kChunkMagic[4] = { 'A', 'D', 'L', 'C' };
+        const uint32_t kLogVersion = 2;
+
+        // 每列元素字节数，与 LogColumn 顺序一致
+        const uint32_t kColumnSize[LOG_COLUMN_COUNT] = {
+            1, 2,
+            2, 2, 1, 1, 1,
+            2, 2, 1, 1, 1,
+            2, 2, 2, 2,
+            1, 1, 1
+        };
+
+        struct LogFileHeader {
+            char magic[4];
+            uint32_t version;
+            uint32_t header_size;
+            uint32_t column_count;
+        };
+
+        // 块头，之后为各列数据（每列8字节对齐）
+        struct LogChunkHeader {
+            char magic[4];
+            uint32_t rows;
+            uint64_t base_frame;
+            int64_t base_timestamp_ns;
+            uint64_t last_frame;
+            uint64_t chunk_size;    // 含块头
+        };
+
+        uint64_t align8(uint64_t value) {
+            return (value + 7) & ~static_cast<uint64_t>(7);
+        }
+
+        uint64_t chunkSize(uint32_t rows) {
+            uint64_t size = sizeof(LogChunkHeader);
+            for (int c = 0; c < LOG_COLUMN_COUNT; ++c) {
+                size += align8(static_cast<uint64_t>(rows) * kColumnSize[c]);
+            }
+            return size;
+        }
+
+        template <typename T>
+        T quantize(float value, float scale) {
+            float q = std::round(value * scale);
+            q = std::max(q, static_cast<float>(std::numeric_limits<T>::min()));
+            q = std::min(q, static_cast<float>(std::numeric_limits<T>::max()));
+            return static_cast<T>(q);
+        }
+
+        template <typename T>
+        void put(std::vector<uint8_t>& column, T value) {
+            size_t n = column.size();
+            column.resize(n + sizeof(T));
+            std::memcpy(&column[n], &value, sizeof(T));
+        }
+    }
+
+    DetectionLogWriter::DetectionLogWriter()
+        : file_(nullptr), rows_(0), base_frame_(0), base_timestamp_ns_(0), last_frame_(0), last_ticks_(0) {
+    }
+
+    DetectionLogWriter::~DetectionLogWriter() {
+        close();
+    }
+
+    bool DetectionLogWriter::open(const std::string& path) {
+        close();
+
+        file_ = std::fopen(path.c_str(), "r+b");
+        if (file_ != nullptr) {
+            // 已有日志：校验文件头，跳过完整的块，从最后一个完整块之后续写
+            LogFileHeader header;
+            if (std::fread(&header, sizeof(header), 1, file_) != 1 ||
+                std::memcmp(header.magic, kLogMagic, 4) != 0 || header.version != kLogVersion ||
+                header.column_count != LOG_COLUMN_COUNT) {
+                std::cerr << "错误: 日志文件格式不匹配 " << path << std::endl;
+                close();
+                return false;
+            }
+
+            long end = sizeof(LogFileHeader);
+            LogChunkHeader chunk;
+            while (std::fseek(file_, end, SEEK_SET) == 0 &&
+                std::fread(&chunk, sizeof(chunk), 1, file_) == 1 &&
+                std::memcmp(chunk.magic, kChunkMagic, 4) == 0 &&
+                chunk.chunk_size == chunkSize(chunk.rows) &&
+                std::fseek(file_, end + static_cast<long>(chunk.chunk_size) - 1, SEEK_SET) == 0 &&
+                std::fgetc(file_) != EOF) {
+                end += static_cast<long>(chunk.chunk_size);
+            }
+            std::fseek(file_, end, SEEK_SET);
+        }
+        else {
+            file_ = std::fopen(path.c_str(), "wb");
+            if (file_ == nullptr) {
+                std::cerr << "错误: 无法创建日志文件 " << path << std::endl;
+                return false;
+            }
+            LogFileHeader header;
+            std::memcpy(header.magic, kLogMagic, 4);
+            header.version = kLogVersion;
+            header.header_size = sizeof(LogFileHeader);
+            header.column_count = LOG_COLUMN_COUNT;
+            std::fwrite(&header, sizeof(header), 1, file_);
+        }
+
+        for (int c = 0; c < LOG_COLUMN_COUNT; ++c) {
+            columns_[c].clear();
+            columns_[c].reserve(kChunkRows * kColumnSize[c]);
+        }
+        rows_ = 0;
+        return true;
+    }
+
+    void DetectionLogWriter::close() {
+        if (file_ == nullptr) {
+            return;
+        }
+        flush();
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    void DetectionLogWriter::append(const LogDetection& d) {
+        if (file_ == nullptr) {
+            return;
+        }
+
+        // 时间按块首量化为刻度，差分的是刻度而不是量化后的差值，误差不累积
+        // 帧号或时间倒退、差值超出列宽时另起一块
+        int64_t ticks = (d.timestamp_ns - base_timestamp_ns_) / kLogTimeUnitNs;
+        if (rows_ > 0 && (d.frame_index < last_frame_ || d.timestamp_ns < base_timestamp_ns_ ||
+            d.frame_index - last_frame_ > std::numeric_limits<uint8_t>::max() ||
+            ticks < last_ticks_ || ticks - last_ticks_ > std::numeric_limits<uint16_t>::max())) {
+            flush();
+        }
+        if (rows_ == 0) {
+            base_frame_ = d.frame_index;
+            base_timestamp_ns_ = d.timestamp_ns;
+            last_frame_ = d.frame_index;
+            last_ticks_ = 0;
+            ticks = 0;
+        }
+
+        put(columns_[LOG_FRAME], static_cast<uint8_t>(d.frame_index - last_frame_));
+        put(columns_[LOG_TIME], static_cast<uint16_t>(ticks - last_ticks_));
+        last_frame_ = d.frame_index;
+        last_ticks_ = ticks;
+
+        const LogColumn bars[2] = { LOG_LEFT_X, LOG_RIGHT_X };
+        const float* values[2] = { d.left, d.right };
+        for (int b = 0; b < 2; ++b) {
+            put(columns_[bars[b]], quantize<int16_t>(values[b][0], kLogPositionScale));
+            put(columns_[bars[b] + 1], quantize<int16_t>(values[b][1], kLogPositionScale));
+            put(columns_[bars[b] + 2], quantize<uint8_t>(values[b][2], kLogSizeScale));
+            put(columns_[bars[b] + 3], quantize<uint8_t>(values[b][3], kLogSizeScale));
+            put(columns_[bars[b] + 4], quantize<int8_t>(values[b][4], kLogAngleScale));
+        }
+        for (int k = 0; k < 4; ++k) {
+            put(columns_[LOG_RECT_X + k], quantize<int16_t>(static_cast<float>(d.rect[k]), 1.0f));
+        }
+        put(columns_[LOG_NUMBER], quantize<int8_t>(static_cast<float>(d.number), 1.0f));
+        put(columns_[LOG_CONFIDENCE], quantize<uint8_t>(d.confidence, 255.0f));
+        put(columns_[LOG_FLAGS], static_cast<uint8_t>((d.is_large ? 1 : 0) | (d.color << 1)));
+
+        if (++rows_ == kChunkRows) {
+            flush();
+        }
+    }
+
+    void DetectionLogWriter::flush() {
+        if (file_ == nullptr || rows_ == 0) {
+            return;
+        }
+
+        LogChunkHeader header;
+        std::memcpy(header.magic, kChunkMagic, 4);
+        header.rows = rows_;
+        header.base_frame = base_frame_;
+        header.base_timestamp_ns = base_timestamp_ns_;
+        header.last_frame = last_frame_;
+        header.chunk_size = chunkSize(rows_);
+        std::fwrite(&header, sizeof(header), 1, file_);
+
+        const uint8_t padding[8] = { 0 };
+        for (int c = 0; c < LOG_COLUMN_COUNT; ++c) {
+            std::fwrite(columns_[c].data(), 1, columns_[c].size(), file_);
+            std::fwrite(padding, 1, align8(columns_[c].size()) - columns_[c].size(), file_);
+            columns_[c].clear();
+        }
+        std::fflush(file_);
+        rows_ = 0;
+    }
+
+    DetectionLogReader::DetectionLogReader()
+        : data_(nullptr), size_(0), handle_(nullptr), row_count_(0) {
+    }
+
+    DetectionLogReader::~DetectionLogReader() {
+        close();
+    }
+
+    bool DetectionLogReader::open(const std::string& path) {
+        close();
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            std::cerr << "错误: 无法打开日志文件 " << path << std::endl;
+            return false;
+        }
+        LARGE_INTEGER file_size;
+        GetFileSizeEx(file, &file_size);
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            std::cerr << "错误: 无法映射日志文件 " << path << std::endl;
+            return false;
+        }
+        void* addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (addr == nullptr) {
+            CloseHandle(mapping);
+            std::cerr << "错误: 无法映射日志文件 " << path << std::endl;
+            return false;
+        }
+        handle_ = mapping;
+        size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "错误: 无法打开日志文件 " << path << std::endl;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            std::cerr << "错误: 日志文件为空 " << path << std::endl;
+            return false;
+        }
+        void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            std::cerr << "错误: 无法映射日志文件 " << path << std::endl;
+            return false;
+        }
+        size_ = static_cast<size_t>(st.st_size);
+#endif
+        data_ = static_cast<const unsigned char*>(addr);
+
+        const LogFileHeader* header = reinterpret_cast<const LogFileHeader*>(data_);
+        if (size_ < sizeof(LogFileHeader) || std::memcmp(header->magic, kLogMagic, 4) != 0 ||
+            header->version != kLogVersion || header->column_count != LOG_COLUMN_COUNT) {
+            std::cerr << "错误: 日志文件格式或版本不匹配 " << path << std::endl;
+            close();
+            return false;
+        }
+
+        // 建立块索引
+        uint64_t offset = header->header_size;
+        while (offset + sizeof(LogChunkHeader) <= size_) {
+            const LogChunkHeader* chunk = reinterpret_cast<const LogChunkHeader*>(data_ + offset);
+            if (std::memcmp(chunk->magic, kChunkMagic, 4) != 0 ||
+                chunk->chunk_size != chunkSize(chunk->rows) || offset + chunk->chunk_size > size_) {
+                break;
+            }
+
+            LogChunkView view;
+            view.rows = chunk->rows;
+            view.base_frame = chunk->base_frame;
+            view.base_timestamp_ns = chunk->base_timestamp_ns;
+            view.last_frame = chunk->last_frame;
+            uint64_t column_offset = offset + sizeof(LogChunkHeader);
+            for (int c = 0; c < LOG_COLUMN_COUNT; ++c) {
+                view.columns[c] = data_ + column_offset;
+                column_offset += align8(static_cast<uint64_t>(chunk->rows) * kColumnSize[c]);
+            }
+            chunks_.push_back(view);
+            row_count_ += chunk->rows;
+            offset += chunk->chunk_size;
+        }
+
+        return true;
+    }
+
+    void DetectionLogReader::close() {
+        chunks_.clear();
+        row_count_ = 0;
+
+        if (data_ == nullptr) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+        CloseHandle(static_cast<HANDLE>(handle_));
+        handle_ = nullptr;
+#else
+        munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+} // namespace AutoAim
\ No newline at end of file
@@ -0,0 +1,141 @@
+﻿#ifndef DETECTION_LOG_HPP
+#define DETECTION_LOG_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// 列式检测日志：追加写入，按块存储，每块内每个字段连续存放（结构数组转数组结构）
+// 帧号与时间戳按行差分，其余数值量化为窄定长整数，一条检测28字节，读端mmap后直接按列扫描
+// （每秒100条检测约10MB/小时；再小需要变长或熵编码，列就不能按下标直接访问了）
+// 不依赖OpenCV，离线分析工具可单独链接
+
+namespace AutoAim {
+
+    // 单条检测（写入接口）
+    struct LogDetection {
+        uint64_t frame_index;
+        int64_t timestamp_ns;   // steady_clock
+        float left[5];          // 左灯条 cx, cy, width, height, angle
+        float right[5];         // 右灯条
+        int32_t rect[4];        // x, y, width, height
+        int32_t number;         // -1 未识别
+        float confidence;
+        uint8_t is_large;
+        uint8_t color;          // LightColor
+    };
+
+    // 列编号，文件中各列按此顺序存放
+    enum LogColumn {
+        LOG_FRAME,              // uint8 与上一行的帧号差（块首行为0）
+        LOG_TIME,               // uint16 与上一行的时间差（kLogTimeUnitNs）
+        LOG_LEFT_X, LOG_LEFT_Y, // int16
+        LOG_LEFT_W, LOG_LEFT_H, // uint8
+        LOG_LEFT_ANGLE,         // int8
+        LOG_RIGHT_X, LOG_RIGHT_Y, LOG_RIGHT_W, LOG_RIGHT_H, LOG_RIGHT_ANGLE,    // 同左灯条
+        LOG_RECT_X, LOG_RECT_Y, LOG_RECT_W, LOG_RECT_H,                         // int16
+        LOG_NUMBER,             // int8
+        LOG_CONFIDENCE,         // uint8 (x255)
+        LOG_FLAGS,              // uint8 bit0 大装甲板，bit1-2 LightColor
+        LOG_COLUMN_COUNT
+    };
+
+    // 量化：中心坐标 1/4 像素，灯条尺寸 1/2 像素（上限127.5），角度 1 度，时间 10 微秒
+    const float kLogPositionScale = 4.0f;
+    const float kLogSizeScale = 2.0f;
+    const float kLogAngleScale = 1.0f;
+    const int64_t kLogTimeUnitNs = 10000;
+
+    // 只读的块视图，列指针指向映射内存
+    struct LogChunkView {
+        uint32_t rows;
+        uint64_t base_frame;            // 首行帧号
+        int64_t base_timestamp_ns;      // 首行时间
+        uint64_t last_frame;            // 末行帧号（按帧范围跳过整块）
+        const void* columns[LOG_COLUMN_COUNT];
+
+        template <typename T>
+        const T* column(LogColumn c) const { return static_cast<const T*>(columns[c]); }
+
+        // 帧号与时间戳是差分列，顺序扫描时从 begin() 开始逐行 step() 还原
+        struct Cursor {
+            uint64_t frame;
+            int64_t timestamp_ns;
+        };
+        Cursor begin() const { Cursor c = { base_frame, base_timestamp_ns }; return c; }
+        void step(Cursor& c, uint32_t i) const {
+            c.frame += column<uint8_t>(LOG_FRAME)[i];
+            c.timestamp_ns += column<uint16_t>(LOG_TIME)[i] * kLogTimeUnitNs;
+        }
+
+        float position(LogColumn c, uint32_t i) const { return column<int16_t>(c)[i] / kLogPositionScale; }
+        float size(LogColumn c, uint32_t i) const { return column<uint8_t>(c)[i] / kLogSizeScale; }
+        float angle(LogColumn c, uint32_t i) const { return column<int8_t>(c)[i] / kLogAngleScale; }
+        int number(uint32_t i) const { return column<int8_t>(LOG_NUMBER)[i]; }
+        float confidence(uint32_t i) const { return column<uint8_t>(LOG_CONFIDENCE)[i] / 255.0f; }
+        bool isLarge(uint32_t i) const { return (column<uint8_t>(LOG_FLAGS)[i] & 1) != 0; }
+        int color(uint32_t i) const { return column<uint8_t>(LOG_FLAGS)[i] >> 1; }
+    };
+
+    // 追加写入
+    class DetectionLogWriter {
+    public:
+        DetectionLogWriter();
+        ~DetectionLogWriter();
+
+        // 文件已存在且格式匹配时在末尾追加，否则新建
+        bool open(const std::string& path);
+        void close();
+
+        bool isOpen() const { return file_ != nullptr; }
+
+        void append(const LogDetection& detection);
+
+        // 写出当前块
+        void flush();
+
+    private:
+        static const uint32_t kChunkRows = 8192;
+
+        DetectionLogWriter(const DetectionLogWriter&);
+        DetectionLogWriter& operator=(const DetectionLogWriter&);
+
+    private:
+        FILE* file_;
+        uint32_t rows_;
+        uint64_t base_frame_;
+        int64_t base_timestamp_ns_;
+        uint64_t last_frame_;           // 上一行帧号
+        int64_t last_ticks_;            // 上一行相对块首的时间（kLogTimeUnitNs）
+        std::vector<uint8_t> columns_[LOG_COLUMN_COUNT];
+    };
+
+    // mmap只读访问
+    class DetectionLogReader {
+    public:
+        DetectionLogReader();
+        ~DetectionLogReader();
+
+        // 映射并建立块索引，末尾不完整的块被忽略
+        bool open(const std::string& path);
+        void close();
+
+        const std::vector<LogChunkView>& chunks() const { return chunks_; }
+        uint64_t rowCount() const { return row_count_; }
+
+    private:
+        DetectionLogReader(const DetectionLogReader&);
+        DetectionLogReader& operator=(const DetectionLogReader&);
+
+    private:
+        const unsigned char* data_;
+        size_t size_;
+        void* handle_;
+        std::vector<LogChunkView> chunks_;
+        uint64_t row_count_;
+    };
+
+} // namespace AutoAim
+
+#endif // DETECTION_LOG_HPP
\ No newline at end of file
@@ -0,0 +1,152 @@
+﻿// 检测日志查询工具：按列扫描统计各数字的命中情况
+// 用法: detection_log_query <日志文件> [--min_confidence 0.0] [--frames 起始:结束]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "DetectionLog.hpp"
+
+using namespace AutoAim;
+
+namespace {
+
+    struct QueryConfig {
+        std::string path;
+        float min_confidence;
+        uint64_t first_frame;
+        uint64_t last_frame;
+
+        QueryConfig() : min_confidence(0.0f), first_frame(0), last_frame(UINT64_MAX) {}
+    };
+
+    // 按数字统计（下标为 number + 128）
+    struct NumberStats {
+        uint64_t detections;
+        uint64_t frames;            // 出现过该数字的帧数
+        uint64_t large;
+        double confidence_sum;
+        uint64_t last_frame;        // 去重用
+
+        NumberStats() : detections(0), frames(0), large(0), confidence_sum(0.0), last_frame(UINT64_MAX) {}
+    };
+
+    bool parseArguments(int argc, char** argv, QueryConfig& config) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--min_confidence" && i + 1 < argc) {
+                config.min_confidence = static_cast<float>(std::atof(argv[++i]));
+            }
+            else if (arg == "--frames" && i + 1 < argc) {
+                std::string range = argv[++i];
+                size_t colon = range.find(':');
+                if (colon == std::string::npos) {
+                    return false;
+                }
+                config.first_frame = std::strtoull(range.substr(0, colon).c_str(), nullptr, 10);
+                if (colon + 1 < range.size()) {
+                    config.last_frame = std::strtoull(range.substr(colon + 1).c_str(), nullptr, 10);
+                }
+            }
+            else if (arg[0] != '-' && config.path.empty()) {
+                config.path = arg;
+            }
+            else {
+                return false;
+            }
+        }
+        return !config.path.empty();
+    }
+
+}
+
+int main(int argc, char** argv) {
+    QueryConfig config;
+    if (!parseArguments(argc, argv, config)) {
+        std::cout << "用法: detection_log_query <日志文件> [--min_confidence 0.0] [--frames 起始:结束]" << std::endl;
+        return 1;
+    }
+
+    DetectionLogReader reader;
+    if (!reader.open(config.path)) {
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    NumberStats stats[256];
+    uint64_t matched = 0;
+    uint64_t scanned = 0;
+    uint64_t frames = 0;
+    uint64_t last_frame = UINT64_MAX;
+    int64_t first_ns = 0, last_ns = 0;
+    const uint8_t min_confidence = static_cast<uint8_t>(config.min_confidence * 255.0f + 0.5f);
+
+    for (const auto& chunk : reader.chunks()) {
+        // 整块不在帧范围内时跳过
+        if (chunk.rows == 0 || chunk.last_frame < config.first_frame ||
+            chunk.base_frame > config.last_frame) {
+            continue;
+        }
+
+        scanned += chunk.rows;
+        const int8_t* number_col = chunk.column<int8_t>(LOG_NUMBER);
+        const uint8_t* confidence_col = chunk.column<uint8_t>(LOG_CONFIDENCE);
+        const uint8_t* flags_col = chunk.column<uint8_t>(LOG_FLAGS);
+
+        LogChunkView::Cursor cursor = chunk.begin();
+        for (uint32_t i = 0; i < chunk.rows; ++i) {
+            chunk.step(cursor, i);
+            uint64_t frame = cursor.frame;
+            if (frame < config.first_frame || frame > config.last_frame ||
+                confidence_col[i] < min_confidence) {
+                continue;
+            }
+
+            if (frame != last_frame) {
+                last_frame = frame;
+                ++frames;
+                last_ns = cursor.timestamp_ns;
+                if (frames == 1) {
+                    first_ns = last_ns;
+                }
+            }
+
+            NumberStats& s = stats[number_col[i] + 128];
+            ++s.detections;
+            s.large += flags_col[i] & 1;
+            s.confidence_sum += confidence_col[i];
+            if (s.last_frame != frame) {
+                s.last_frame = frame;
+                ++s.frames;
+            }
+            ++matched;
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "块数: " << reader.chunks().size() << "，检测总数: " << reader.rowCount() << std::endl;
+    std::cout << "匹配检测: " << matched << "，有检测的帧: " << frames
+        << "，时长: " << (last_ns - first_ns) / 1e9 << " 秒" << std::endl;
+    std::cout << "扫描耗时: " << elapsed * 1000.0 << " ms ("
+        << (elapsed > 0 ? scanned / elapsed / 1e6 : 0.0) << " M检测/秒)" << std::endl;
+
+    std::printf("%8s %10s %8s %10s %10s %8s\n", "数字", "检测数", "占比", "命中帧", "帧命中率", "置信度");
+    for (int k = 0; k < 256; ++k) {
+        const NumberStats& s = stats[k];
+        if (s.detections == 0) {
+            continue;
+        }
+        int number = k - 128;
+        std::printf("%8s %10llu %7.2f%% %10llu %9.2f%% %8.3f\n",
+            number < 0 ? "未识别" : std::to_string(number).c_str(),
+            static_cast<unsigned long long>(s.detections), 100.0 * s.detections / matched,
+            static_cast<unsigned long long>(s.frames), 100.0 * s.frames / frames,
+            s.confidence_sum / s.detections / 255.0);
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+﻿#include "DetectionPublisher.hpp"
+#include "DetectionEngine.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace AutoAim {
+
+    DetectionPublisher::DetectionPublisher() : open_(false) {
+    }
+
+    bool DetectionPublisher::open(const std::string& name, const cv::Mat& camera_matrix) {
+        ShmCamera camera;
+        bool has_camera = camera_matrix.rows == 3 && camera_matrix.cols == 3;
+        if (has_camera) {
+            cv::Mat k;
+            camera_matrix.convertTo(k, CV_64F);
+            camera.fx = k.at<double>(0, 0);
+            camera.fy = k.at<double>(1, 1);
+            camera.cx = k.at<double>(0, 2);
+            camera.cy = k.at<double>(1, 2);
+        }
+        open_ = writer_.create(name, has_camera ? &camera : nullptr);
+        if (open_) {
+            std::cout << "检测结果发布到共享内存: " << name << std::endl;
+        }
+        return open_;
+    }
+
+    void DetectionPublisher::publish(uint64_t frame_index, int64_t timestamp_ns,
+        const std::vector<Armor>& armors) {
+        ShmFrame* frame = writer_.beginWrite();
+        if (frame == nullptr) {
+            return;
+        }
+
+        frame->frame_index = frame_index;
+        frame->timestamp_ns = timestamp_ns;
+        frame->count = static_cast<uint32_t>(std::min<size_t>(armors.size(), kShmMaxArmors));
+
+        for (uint32_t i = 0; i < frame->count; ++i) {
+            DetectionEngine::toShmArmor(armors[i], frame->armors[i]);
+        }
+
+        writer_.endWrite();
+    }
+
+} // namespace AutoAim
\ No newline at end of file
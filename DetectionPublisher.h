@@ -0,0 +1,32 @@
+﻿#ifndef DETECTION_PUBLISHER_HPP
+#define DETECTION_PUBLISHER_HPP
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include "Utils.hpp"
+#include "DetectionShm.hpp"
+
+namespace AutoAim {
+
+    // 将每帧装甲板结果发布到共享内存，供本机其他进程读取
+    class DetectionPublisher {
+    public:
+        DetectionPublisher();
+
+        // 创建共享内存；camera_matrix（3x3）非空时将内参发布给读端
+        bool open(const std::string& name, const cv::Mat& camera_matrix = cv::Mat());
+
+        bool isOpen() const { return open_; }
+
+        // 发布一帧结果，超出 kShmMaxArmors 的装甲板被截断
+        void publish(uint64_t frame_index, int64_t timestamp_ns, const std::vector<Armor>& armors);
+
+    private:
+        DetectionWriter writer_;
+        bool open_;
+    };
+
+} // namespace AutoAim
+
+#endif // DETECTION_PUBLISHER_HPP
\ No newline at end of file
@@ -0,0 +1,286 @@
+﻿#include "DetectionShm.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace AutoAim {
+
+    static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+        "shared memory seqlock requires lock-free atomics");
+
+    int64_t shmNowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // ---------------- ShmRegion ----------------
+
+    ShmRegion::ShmRegion() : layout_(nullptr), owner_(false), handle_(nullptr) {
+    }
+
+    ShmRegion::~ShmRegion() {
+        close();
+    }
+
+    bool ShmRegion::create(const std::string& name, const ShmCamera* camera) {
+        if (!map(name, true)) {
+            return false;
+        }
+
+        ShmHeader& header = layout_->header;
+        header.ring_size = kShmRingSize;
+        header.max_armors = kShmMaxArmors;
+        header.version = kShmVersion;
+        header.published.store(0, std::memory_order_relaxed);
+        header.has_camera = camera != nullptr ? 1 : 0;
+        header.reserved = 0;
+        if (camera != nullptr) {
+            header.camera = *camera;
+        }
+        for (uint32_t i = 0; i < kShmRingSize; ++i) {
+            layout_->slots[i].seq.store(0, std::memory_order_relaxed);
+        }
+
+        // magic最后写入，读端据此判断初始化完成
+        std::atomic_thread_fence(std::memory_order_release);
+        header.magic = kShmMagic;
+        return true;
+    }
+
+    bool ShmRegion::open(const std::string& name) {
+        if (!map(name, false)) {
+            return false;
+        }
+
+        const ShmHeader& header = layout_->header;
+        if (header.magic != kShmMagic || header.version != kShmVersion ||
+            header.ring_size != kShmRingSize || header.max_armors != kShmMaxArmors) {
+            std::cerr << "错误: 共享内存 " << name << " 版本不匹配" << std::endl;
+            close();
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return true;
+    }
+
+#ifdef _WIN32
+    bool ShmRegion::map(const std::string& name, bool create) {
+        close();
+
+        HANDLE mapping = create
+            ? CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                0, static_cast<DWORD>(sizeof(ShmLayout)), name.c_str())
+            : OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+        if (mapping == nullptr) {
+            std::cerr << "错误: 无法打开共享内存 " << name << std::endl;
+            return false;
+        }
+
+        void* addr = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(ShmLayout));
+        if (addr == nullptr) {
+            CloseHandle(mapping);
+            std::cerr << "错误: 无法映射共享内存 " << name << std::endl;
+            return false;
+        }
+
+        name_ = name;
+        handle_ = mapping;
+        layout_ = static_cast<ShmLayout*>(addr);
+        owner_ = create;
+        return true;
+    }
+
+    void ShmRegion::close() {
+        if (layout_ != nullptr) {
+            UnmapViewOfFile(layout_);
+            layout_ = nullptr;
+        }
+        if (handle_ != nullptr) {
+            CloseHandle(static_cast<HANDLE>(handle_));
+            handle_ = nullptr;
+        }
+        owner_ = false;
+    }
+#else
+    bool ShmRegion::map(const std::string& name, bool create) {
+        close();
+
+        // POSIX共享内存名必须以'/'开头
+        std::string shm_name = (!name.empty() && name[0] == '/') ? name : "/" + name;
+
+        int fd = create
+            ? shm_open(shm_name.c_str(), O_CREAT | O_RDWR, 0666)
+            : shm_open(shm_name.c_str(), O_RDWR, 0666);
+        if (fd < 0) {
+            std::cerr << "错误: 无法打开共享内存 " << shm_name << std::endl;
+            return false;
+        }
+
+        if (create && ftruncate(fd, sizeof(ShmLayout)) != 0) {
+            ::close(fd);
+            std::cerr << "错误: 无法设置共享内存大小 " << shm_name << std::endl;
+            return false;
+        }
+
+        void* addr = mmap(nullptr, sizeof(ShmLayout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            std::cerr << "错误: 无法映射共享内存 " << shm_name << std::endl;
+            return false;
+        }
+
+        name_ = shm_name;
+        layout_ = static_cast<ShmLayout*>(addr);
+        owner_ = create;
+        return true;
+    }
+
+    void ShmRegion::close() {
+        if (layout_ != nullptr) {
+            munmap(layout_, sizeof(ShmLayout));
+            layout_ = nullptr;
+            if (owner_) {
+                shm_unlink(name_.c_str());
+            }
+        }
+        owner_ = false;
+    }
+#endif
+
+    // ---------------- DetectionWriter ----------------
+
+    DetectionWriter::DetectionWriter() : slot_(nullptr) {
+    }
+
+    bool DetectionWriter::create(const std::string& name, const ShmCamera* camera) {
+        slot_ = nullptr;
+        return region_.create(name, camera);
+    }
+
+    ShmFrame* DetectionWriter::beginWrite() {
+        ShmLayout* layout = region_.layout();
+        if (layout == nullptr) {
+            return nullptr;
+        }
+
+        uint64_t index = layout->header.published.load(std::memory_order_relaxed);
+        slot_ = &layout->slots[index % kShmRingSize];
+
+        // 序号置为奇数：读端看到后重试
+        uint32_t seq = slot_->seq.load(std::memory_order_relaxed);
+        slot_->seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot_->frame.sequence = index;
+        return &slot_->frame;
+    }
+
+    void DetectionWriter::endWrite() {
+        if (slot_ == nullptr) {
+            return;
+        }
+
+        ShmLayout* layout = region_.layout();
+        uint32_t seq = slot_->seq.load(std::memory_order_relaxed);
+        slot_->seq.store(seq + 1, std::memory_order_release);
+        layout->header.published.fetch_add(1, std::memory_order_release);
+        slot_ = nullptr;
+    }
+
+    // ---------------- DetectionReader ----------------
+
+    DetectionReader::DetectionReader() : next_(0) {
+    }
+
+    bool DetectionReader::open(const std::string& name) {
+        if (!region_.open(name)) {
+            return false;
+        }
+        next_ = published();
+        return true;
+    }
+
+    bool DetectionReader::camera(ShmCamera& out) const {
+        ShmLayout* layout = region_.layout();
+        if (layout == nullptr || !layout->header.has_camera) {
+            return false;
+        }
+        out = layout->header.camera;
+        return true;
+    }
+
+    uint64_t DetectionReader::published() const {
+        ShmLayout* layout = region_.layout();
+        return layout ? layout->header.published.load(std::memory_order_acquire) : 0;
+    }
+
+    bool DetectionReader::readLatest(ShmFrame& out) {
+        uint64_t count = published();
+        return count > 0 && read(count - 1, out);
+    }
+
+    bool DetectionReader::read(uint64_t index, ShmFrame& out) {
+        ShmLayout* layout = region_.layout();
+        if (layout == nullptr || index >= published()) {
+            return false;
+        }
+
+        const ShmSlot& slot = layout->slots[index % kShmRingSize];
+        while (true) {
+            uint32_t seq1 = slot.seq.load(std::memory_order_acquire);
+            if (seq1 & 1) {
+                // 写端正在写该槽
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::memcpy(&out, &slot.frame, sizeof(ShmFrame));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint32_t seq2 = slot.seq.load(std::memory_order_relaxed);
+            if (seq1 == seq2) {
+                break;
+            }
+        }
+
+        // 槽中已是更新的帧（被覆盖）
+        return out.sequence == index;
+    }
+
+    bool DetectionReader::waitNext(ShmFrame& out, int timeout_us) {
+        // 忙等轮询（让出时间片）以获得微秒级延迟
+        int64_t deadline = shmNowNs() + static_cast<int64_t>(timeout_us) * 1000;
+
+        while (true) {
+            uint64_t count = published();
+            if (count > next_) {
+                // 落后太多，旧帧已被覆盖
+                if (count - next_ > kShmRingSize - 1) {
+                    next_ = count - 1;
+                }
+                if (read(next_, out)) {
+                    next_++;
+                    return true;
+                }
+                next_ = count;
+                continue;
+            }
+
+            if (shmNowNs() >= deadline) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+} // namespace AutoAim
\ No newline at end of file
@@ -0,0 +1,151 @@
+﻿#ifndef DETECTION_SHM_HPP
+#define DETECTION_SHM_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 共享内存检测结果环形缓冲区
+// 布局不依赖OpenCV，读端（云台控制、日志进程）只需包含本头文件
+
+namespace AutoAim {
+
+    const uint32_t kShmMagic = 0x41524d52;     // "ARMR"
+    const uint32_t kShmVersion = 3;
+    const uint32_t kShmRingSize = 64;          // 环形缓冲区槽数
+    const uint32_t kShmMaxArmors = 16;         // 每帧最多发布的装甲板数
+
+    // 灯条几何：旋转矩形
+    struct ShmLight {
+        float cx, cy;       // 中心
+        float width, height;
+        float angle;
+    };
+
+    // 单个装甲板
+    struct ShmArmor {
+        ShmLight left;
+        ShmLight right;
+        int32_t rect[4];    // x, y, width, height
+        int32_t number;     // 识别数字，-1 未识别
+        float confidence;
+        int32_t is_large;
+        int32_t color;      // 灯条颜色（LightColor：0 未标记，1 红，2 蓝），读端据此排除己方
+    };
+
+    // 单帧结果
+    struct ShmFrame {
+        uint64_t sequence;      // 发布序号，由写端填写
+        uint64_t frame_index;   // 视频帧号
+        int64_t timestamp_ns;   // 采集时间，steady_clock（CLOCK_MONOTONIC），跨进程可比
+        uint32_t count;
+        uint32_t reserved;
+        ShmArmor armors[kShmMaxArmors];
+    };
+
+    // 槽：seqlock保护，序号为奇数表示正在写
+    struct ShmSlot {
+        std::atomic<uint32_t> seq;
+        uint32_t reserved;
+        ShmFrame frame;
+    };
+
+    // 相机内参（针孔模型，像素），写端由bundle标定填写，读端瞄准解算用
+    struct ShmCamera {
+        double fx, fy;
+        double cx, cy;
+    };
+
+    struct ShmHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t ring_size;
+        uint32_t max_armors;
+        std::atomic<uint64_t> published;    // 已发布帧数，最新帧位于 (published - 1) % ring_size
+        uint32_t has_camera;                // camera 是否有效
+        uint32_t reserved;
+        ShmCamera camera;
+    };
+
+    struct ShmLayout {
+        ShmHeader header;
+        ShmSlot slots[kShmRingSize];
+    };
+
+    // 获取单调时钟时间（纳秒）
+    int64_t shmNowNs();
+
+    // 共享内存映射（POSIX shm_open / Windows 文件映射）
+    class ShmRegion {
+    public:
+        ShmRegion();
+        ~ShmRegion();
+
+        // camera 非空时写入文件头，在读端可见之前完成
+        bool create(const std::string& name, const ShmCamera* camera = nullptr);
+        bool open(const std::string& name);
+        void close();
+
+        ShmLayout* layout() const { return layout_; }
+
+    private:
+        bool map(const std::string& name, bool create);
+
+        ShmRegion(const ShmRegion&);
+        ShmRegion& operator=(const ShmRegion&);
+
+    private:
+        std::string name_;
+        ShmLayout* layout_;
+        bool owner_;
+        void* handle_;
+    };
+
+    // 写端：单写者
+    class DetectionWriter {
+    public:
+        DetectionWriter();
+
+        // camera 为发布给读端的相机内参，未标定时为空
+        bool create(const std::string& name, const ShmCamera* camera = nullptr);
+
+        // 获取下一个槽并进入写状态，写完后必须调用 endWrite
+        ShmFrame* beginWrite();
+        void endWrite();
+
+    private:
+        ShmRegion region_;
+        ShmSlot* slot_;
+    };
+
+    // 读端：多读者，无锁，不阻塞写端
+    class DetectionReader {
+    public:
+        DetectionReader();
+
+        bool open(const std::string& name);
+
+        // 写端发布的相机内参，未发布时返回false
+        bool camera(ShmCamera& out) const;
+
+        // 已发布帧数
+        uint64_t published() const;
+
+        // 读取最新一帧
+        bool readLatest(ShmFrame& out);
+
+        // 读取第 index 帧（从0开始），已被覆盖或尚未发布时返回false
+        bool read(uint64_t index, ShmFrame& out);
+
+        // 等待并读取下一帧（按发布顺序），超时返回false；落后超过环大小时跳到最新
+        bool waitNext(ShmFrame& out, int timeout_us);
+
+    private:
+        ShmRegion region_;
+        uint64_t next_;
+    };
+
+} // namespace AutoAim
+
+#endif // DETECTION_SHM_HPP
\ No newline at end of file
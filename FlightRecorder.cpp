@@ -0,0 +1,228 @@
+﻿#include "FlightRecorder.hpp"
+#include "Logger.hpp"
+#include <cerrno>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace AutoAim {
+
+    namespace {
+        std::atomic<bool> g_signal_dump(false);
+
+        extern "C" void onDumpSignal(int) {
+            g_signal_dump.store(true);
+        }
+
+        bool makeDirectory(const std::string& path) {
+#ifdef _WIN32
+            return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+#else
+            return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+        }
+    }
+
+    FlightRecorder::FlightRecorder()
+        : capacity_(0),
+        format_(PixelFormat::BGR),
+        next_(0),
+        count_(0),
+        min_tracked_(10),
+        lost_frames_(3),
+        tracked_streak_(0),
+        lost_streak_(0),
+        requested_(false),
+        dumping_(false),
+        dumps_(0) {
+    }
+
+    FlightRecorder::~FlightRecorder() {
+        wait();
+    }
+
+    bool FlightRecorder::open(const std::string& output_dir, int capacity) {
+        if (capacity <= 0 || !makeDirectory(output_dir)) {
+            std::cerr << "错误: 无法创建飞行记录目录 " << output_dir << std::endl;
+            return false;
+        }
+        output_dir_ = output_dir;
+        capacity_ = capacity;
+        slots_.clear();
+        dump_slots_.clear();
+        next_ = 0;
+        count_ = 0;
+        return true;
+    }
+
+    void FlightRecorder::setLostTrackRule(int min_tracked, int lost_frames) {
+        min_tracked_ = min_tracked;
+        lost_frames_ = lost_frames;
+    }
+
+    void FlightRecorder::installSignalHandler() {
+#ifdef SIGUSR1
+        std::signal(SIGUSR1, onDumpSignal);
+#endif
+    }
+
+    void FlightRecorder::trigger() {
+        requested_.store(true);
+    }
+
+    void FlightRecorder::wait() {
+        if (writer_.joinable()) {
+            writer_.join();
+        }
+    }
+
+    void FlightRecorder::allocate(const cv::Mat& frame) {
+        for (std::vector<Slot>* ring : { &slots_, &dump_slots_ }) {
+            ring->resize(capacity_);
+            for (auto& slot : *ring) {
+                // 写一遍以预先触页，录制时只有拷贝
+                slot.frame.create(frame.size(), frame.type());
+                slot.frame.setTo(cv::Scalar(0));
+                slot.light_bars.reserve(32);
+                slot.armors.reserve(8);
+            }
+        }
+
+        double mb = static_cast<double>(frame.total() * frame.elemSize()) * capacity_ * 2 / (1024.0 * 1024.0);
+        std::cout << "飞行记录器: " << capacity_ << " 帧，图像缓冲约 " << mb << " MB" << std::endl;
+    }
+
+    void FlightRecorder::record(uint64_t frame_index, int64_t timestamp_ns, const cv::Mat& frame,
+        PixelFormat format, const cv::Mat& binary, const RunMask& mask,
+        const std::vector<cv::RotatedRect>& light_bars, const std::vector<Armor>& armors) {
+        if (!isOpen()) {
+            return;
+        }
+        if (slots_.empty()) {
+            allocate(frame);
+        }
+        format_ = format;
+
+        Slot& slot = slots_[next_];
+        slot.frame_index = frame_index;
+        slot.timestamp_ns = timestamp_ns;
+        frame.copyTo(slot.frame);
+
+        // 掩码按行程编码保存，槽位的容量跨帧复用；稀疏与流式路径已是行程编码，直接拷贝
+        if (mask.rows() > 0) {
+            slot.mask = mask;
+        }
+        else if (binary.empty()) {
+            slot.mask.reset(0, 0);
+        }
+        else {
+            slot.mask.reset(binary.rows, binary.cols);
+            for (int r = 0; r < binary.rows; ++r) {
+                slot.mask.appendRow(binary.ptr<uchar>(r));
+            }
+        }
+        slot.light_bars.assign(light_bars.begin(), light_bars.end());
+        slot.armors.assign(armors.begin(), armors.end());
+
+        next_ = (next_ + 1) % slots_.size();
+        if (count_ < slots_.size()) {
+            count_++;
+        }
+
+        checkRules(armors);
+
+        if (pending_reason_.empty()) {
+            if (requested_.exchange(false)) {
+                pending_reason_ = "request";
+            }
+            else if (g_signal_dump.exchange(false)) {
+                pending_reason_ = "signal";
+            }
+        }
+        // 上一次写盘未结束时保留原因，写盘结束后的下一帧再转储
+        if (pending_reason_.empty() || dumping_.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        // 回收上一次的写盘线程，交换两个环：写盘线程独占交换出的帧，
+        // 记录从空环重新开始，下一次转储不会混入本次已写出的帧
+        wait();
+        std::string reason;
+        reason.swap(pending_reason_);
+        size_t first = (next_ + slots_.size() - count_) % slots_.size();
+        size_t count = count_;
+        slots_.swap(dump_slots_);
+        next_ = 0;
+        count_ = 0;
+
+        dumping_.store(true, std::memory_order_release);
+        writer_ = std::thread(&FlightRecorder::dump, this, reason, format_, first, count);
+    }
+
+    void FlightRecorder::checkRules(const std::vector<Armor>& armors) {
+        if (!armors.empty()) {
+            tracked_streak_++;
+            lost_streak_ = 0;
+            return;
+        }
+
+        if (tracked_streak_ >= min_tracked_) {
+            lost_streak_++;
+            if (lost_streak_ >= lost_frames_) {
+                pending_reason_ = "lost_track";
+                tracked_streak_ = 0;
+                lost_streak_ = 0;
+            }
+        }
+        else {
+            tracked_streak_ = 0;
+        }
+    }
+
+    void FlightRecorder::dump(const std::string& reason, PixelFormat format, size_t first, size_t count) {
+        int index = dumps_.load() + 1;
+        std::string dir = output_dir_ + "/dump_" + std::to_string(index) + "_" + reason;
+        if (!makeDirectory(dir)) {
+            Logger::instance().logText(LogLevel::Error, "无法创建转储目录: " + dir);
+            dumping_.store(false, std::memory_order_release);
+            return;
+        }
+
+        std::ofstream csv(dir + "/records.csv");
+        csv << "frame,timestamp_ns,kind,cx,cy,width,height,angle,number,is_large,color\n";
+
+        for (size_t k = 0; k < count; ++k) {
+            const Slot& slot = dump_slots_[(first + k) % dump_slots_.size()];
+            std::string stem = dir + "/" + std::to_string(slot.frame_index);
+
+            cv::imwrite(stem + "_frame.png", Utils::toBGR(slot.frame, format));
+            if (slot.mask.rows() > 0) {
+                cv::imwrite(stem + "_mask.png", slot.mask.toMat());
+            }
+
+            for (const auto& bar : slot.light_bars) {
+                csv << slot.frame_index << ',' << slot.timestamp_ns << ",light," << bar.center.x << ','
+                    << bar.center.y << ',' << bar.size.width << ',' << bar.size.height << ','
+                    << bar.angle << ",,,\n";
+            }
+            for (const auto& armor : slot.armors) {
+                const cv::Rect& r = armor.bounding_rect;
+                csv << slot.frame_index << ',' << slot.timestamp_ns << ",armor,"
+                    << r.x + r.width * 0.5 << ',' << r.y + r.height * 0.5 << ',' << r.width << ','
+                    << r.height << ",," << armor.number << ',' << (armor.is_large ? 1 : 0) << ','
+                    << static_cast<int>(armor.color) << '\n';
+            }
+        }
+
+        dumps_++;
+        Logger::instance().logText(LogLevel::Info, "飞行记录已转储: " + dir);
+        dumping_.store(false, std::memory_order_release);
+    }
+
+} // namespace AutoAim
\ No newline at end of file
@@ -0,0 +1,91 @@
+﻿#ifndef FLIGHT_RECORDER_HPP
+#define FLIGHT_RECORDER_HPP
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Utils.hpp"
+#include "RunMask.hpp"
+
+namespace AutoAim {
+
+    // 飞行记录器：在预分配的内存环形缓冲区中保存最近若干帧的输入图像、
+    // 分割掩码（行程编码）、灯条与装甲板，只在触发（按键、信号、目标丢失）时写盘。
+    // 检测线程每帧只有一次图像拷贝和掩码拷贝；触发时与预分配的备用环交换，
+    // 后台线程写出交换出的帧，记录不中断
+    class FlightRecorder {
+    public:
+        FlightRecorder();
+        ~FlightRecorder();
+
+        // output_dir 为转储目录，capacity 为保存的帧数；缓冲区（两个环）在首帧到来时按其尺寸一次分配
+        bool open(const std::string& output_dir, int capacity);
+        bool isOpen() const { return capacity_ > 0; }
+
+        // 目标丢失规则：连续跟踪不少于 min_tracked 帧后，连续 lost_frames 帧无装甲板即触发
+        void setLostTrackRule(int min_tracked, int lost_frames);
+
+        // 记录一帧（检测线程），timestamp_ns 为帧的采集时间
+        // mask 非空时直接保存行程编码，否则编码稠密掩码 binary；两者都为空时不记录掩码
+        void record(uint64_t frame_index, int64_t timestamp_ns, const cv::Mat& frame, PixelFormat format,
+            const cv::Mat& binary, const RunMask& mask, const std::vector<cv::RotatedRect>& light_bars,
+            const std::vector<Armor>& armors);
+
+        // 请求转储（任意线程），在下一次 record 时开始写盘；上一次写盘未结束时顺延
+        void trigger();
+
+        // 安装 SIGUSR1 处理：收到信号后转储（POSIX）
+        static void installSignalHandler();
+
+        // 已完成的转储次数
+        int dumps() const { return dumps_.load(); }
+
+        // 等待正在进行的写盘结束
+        void wait();
+
+    private:
+        struct Slot {
+            uint64_t frame_index;
+            int64_t timestamp_ns;
+            cv::Mat frame;                              // 预分配，拷贝时不再分配
+            RunMask mask;
+            std::vector<cv::RotatedRect> light_bars;
+            std::vector<Armor> armors;
+        };
+
+        // 首帧时分配全部槽位
+        void allocate(const cv::Mat& frame);
+
+        // 按规则检查是否需要触发
+        void checkRules(const std::vector<Armor>& armors);
+
+        // 后台写盘：按时间顺序写出备用环中的有效槽位
+        void dump(const std::string& reason, PixelFormat format, size_t first, size_t count);
+
+    private:
+        std::string output_dir_;
+        int capacity_;
+        PixelFormat format_;
+        std::vector<Slot> slots_;       // 正在记录的环
+        std::vector<Slot> dump_slots_;  // 正在写盘的环，触发时与 slots_ 交换
+        size_t next_;                   // 下一个写入位置
+        size_t count_;                  // 有效帧数
+
+        int min_tracked_;
+        int lost_frames_;
+        int tracked_streak_;            // 连续有装甲板的帧数
+        int lost_streak_;               // 跟踪后连续无装甲板的帧数
+
+        std::string pending_reason_;    // 待转储的原因（检测线程内）
+        std::atomic<bool> requested_;   // 其他线程请求转储
+        std::atomic<bool> dumping_;     // 正在写盘，dump_slots_ 不可交换
+        std::atomic<int> dumps_;
+        std::thread writer_;
+    };
+
+} // namespace AutoAim
+
+#endif // FLIGHT_RECORDER_HPP
\ No newline at end of file
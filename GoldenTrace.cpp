@@ -0,0 +1,180 @@
+﻿#include "GoldenTrace.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+namespace AutoAim {
+
+    namespace {
+        const char* kGoldenHeader = "# auto_aim golden v1";
+        const char* kStageNames[] = { "mask", "light_bars", "armors", "numbers" };
+
+        uint64_t hashRotatedRect(const cv::RotatedRect& rect, uint64_t seed) {
+            float values[5] = { rect.center.x, rect.center.y, rect.size.width, rect.size.height, rect.angle };
+            return GoldenTrace::hashBytes(values, sizeof(values), seed);
+        }
+    }
+
+    GoldenTrace::GoldenTrace()
+        : mode_(DISABLED), frames_(0), mismatched_frames_(0), finished_(false) {
+    }
+
+    bool GoldenTrace::open(const std::string& path, Mode mode) {
+        path_ = path;
+        mode_ = DISABLED;
+
+        if (mode == RECORD) {
+            out_.open(path);
+            if (!out_) {
+                std::cerr << "错误: 无法创建golden文件 " << path << std::endl;
+                return false;
+            }
+            out_ << kGoldenHeader << "\n";
+        }
+        else if (mode == CHECK) {
+            std::ifstream in(path);
+            std::string line;
+            if (!in || !std::getline(in, line) || line != kGoldenHeader) {
+                std::cerr << "错误: 无法读取golden文件 " << path << std::endl;
+                return false;
+            }
+
+            while (std::getline(in, line)) {
+                std::istringstream iss(line);
+                int frame_index;
+                FrameHashes h;
+                if (!(iss >> frame_index >> std::hex >> h.mask >> h.light_bars >> h.armors >> h.numbers)) {
+                    continue;
+                }
+                if (frame_index >= 1) {
+                    golden_.resize(std::max<size_t>(golden_.size(), frame_index));
+                    golden_[frame_index - 1] = h;
+                }
+            }
+            std::cout << "golden文件: " << golden_.size() << " 帧" << std::endl;
+        }
+
+        mode_ = mode;
+        return true;
+    }
+
+    void GoldenTrace::addFrame(int frame_index, const FrameHashes& hashes) {
+        frames_++;
+
+        if (mode_ == RECORD) {
+            out_ << frame_index << std::hex
+                << ' ' << hashes.mask << ' ' << hashes.light_bars
+                << ' ' << hashes.armors << ' ' << hashes.numbers << std::dec << "\n";
+            return;
+        }
+
+        if (mode_ != CHECK) {
+            return;
+        }
+
+        if (frame_index < 1 || frame_index > static_cast<int>(golden_.size())) {
+            if (mismatched_frames_++ == 0) {
+                std::cout << "\n回归检查失败: 第 " << frame_index << " 帧不在golden文件中" << std::endl;
+            }
+            return;
+        }
+
+        // 按流水线顺序找到第一个不一致的阶段
+        const FrameHashes& expected = golden_[frame_index - 1];
+        const uint64_t actual_values[] = { hashes.mask, hashes.light_bars, hashes.armors, hashes.numbers };
+        const uint64_t expected_values[] = { expected.mask, expected.light_bars, expected.armors, expected.numbers };
+
+        for (int stage = 0; stage < 4; ++stage) {
+            if (actual_values[stage] != expected_values[stage]) {
+                if (mismatched_frames_ == 0) {
+                    std::cout << "\n回归检查失败: 第 " << frame_index << " 帧, 阶段 "
+                        << kStageNames[stage] << " 首先出现差异" << std::endl;
+                }
+                mismatched_frames_++;
+                break;
+            }
+        }
+    }
+
+    bool GoldenTrace::finish() {
+        if (mode_ == DISABLED || finished_) {
+            return mismatched_frames_ == 0;
+        }
+        finished_ = true;
+
+        if (mode_ == RECORD) {
+            out_.close();
+            std::cout << "golden文件已记录: " << path_ << " (" << frames_ << " 帧)" << std::endl;
+            return true;
+        }
+
+        if (frames_ < static_cast<int>(golden_.size())) {
+            std::cout << "回归检查失败: 只处理了 " << frames_ << " 帧, golden文件有 "
+                << golden_.size() << " 帧" << std::endl;
+            return false;
+        }
+
+        if (mismatched_frames_ == 0) {
+            std::cout << "回归检查通过: " << frames_ << " 帧逐位一致" << std::endl;
+        }
+        else {
+            std::cout << "回归检查失败: " << mismatched_frames_ << " / " << frames_ << " 帧不一致" << std::endl;
+        }
+        return mismatched_frames_ == 0;
+    }
+
+    uint64_t GoldenTrace::hashBytes(const void* data, size_t size, uint64_t seed) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        uint64_t h = seed;
+        for (size_t i = 0; i < size; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    uint64_t GoldenTrace::hashMat(const cv::Mat& mat) {
+        int header[3] = { mat.rows, mat.cols, mat.type() };
+        uint64_t h = hashBytes(header, sizeof(header));
+
+        // 逐行哈希，忽略行尾填充
+        size_t row_bytes = mat.cols * mat.elemSize();
+        for (int r = 0; r < mat.rows; ++r) {
+            h = hashBytes(mat.ptr(r), row_bytes, h);
+        }
+        return h;
+    }
+
+    uint64_t GoldenTrace::hashLightBars(const std::vector<cv::RotatedRect>& light_bars) {
+        uint32_t count = static_cast<uint32_t>(light_bars.size());
+        uint64_t h = hashBytes(&count, sizeof(count));
+        for (const auto& rect : light_bars) {
+            h = hashRotatedRect(rect, h);
+        }
+        return h;
+    }
+
+    uint64_t GoldenTrace::hashArmors(const std::vector<Armor>& armors) {
+        uint32_t count = static_cast<uint32_t>(armors.size());
+        uint64_t h = hashBytes(&count, sizeof(count));
+        for (const auto& armor : armors) {
+            h = hashRotatedRect(armor.left_light, h);
+            h = hashRotatedRect(armor.right_light, h);
+            int values[5] = { armor.bounding_rect.x, armor.bounding_rect.y,
+                armor.bounding_rect.width, armor.bounding_rect.height, armor.is_large ? 1 : 0 };
+            h = hashBytes(values, sizeof(values), h);
+        }
+        return h;
+    }
+
+    uint64_t GoldenTrace::hashNumbers(const std::vector<Armor>& armors) {
+        uint32_t count = static_cast<uint32_t>(armors.size());
+        uint64_t h = hashBytes(&count, sizeof(count));
+        for (const auto& armor : armors) {
+            h = hashBytes(&armor.number, sizeof(armor.number), h);
+            h = hashBytes(&armor.confidence, sizeof(armor.confidence), h);
+        }
+        return h;
+    }
+
+} // namespace AutoAim
\ No newline at end of file
@@ -0,0 +1,65 @@
+﻿#ifndef GOLDEN_TRACE_HPP
+#define GOLDEN_TRACE_HPP
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Utils.hpp"
+
+namespace AutoAim {
+
+    // 每帧各阶段输出的哈希
+    struct FrameHashes {
+        uint64_t mask;          // 分割掩码
+        uint64_t light_bars;    // 灯条列表
+        uint64_t armors;        // 装甲板列表（识别前）
+        uint64_t numbers;       // 识别数字
+
+        FrameHashes() : mask(0), light_bars(0), armors(0), numbers(0) {}
+    };
+
+    // 逐位一致的回归检查：参考版本记录各阶段哈希到golden文件，
+    // 优化版本与之逐帧比对，报告第一个出现差异的帧和阶段
+    class GoldenTrace {
+    public:
+        enum Mode {
+            DISABLED,
+            RECORD,
+            CHECK
+        };
+
+        GoldenTrace();
+
+        // 打开golden文件
+        bool open(const std::string& path, Mode mode);
+
+        bool isOpen() const { return mode_ != DISABLED; }
+
+        // 提交一帧（帧号从1开始，按顺序）
+        void addFrame(int frame_index, const FrameHashes& hashes);
+
+        // 结束并输出汇总，返回是否通过
+        bool finish();
+
+        // FNV-1a 哈希
+        static uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 14695981039346656037ULL);
+        static uint64_t hashMat(const cv::Mat& mat);
+        static uint64_t hashLightBars(const std::vector<cv::RotatedRect>& light_bars);
+        static uint64_t hashArmors(const std::vector<Armor>& armors);
+        static uint64_t hashNumbers(const std::vector<Armor>& armors);
+
+    private:
+        Mode mode_;
+        std::string path_;
+        std::ofstream out_;
+        std::vector<FrameHashes> golden_;   // CHECK模式下读入的参考哈希
+        int frames_;                        // 已提交帧数
+        int mismatched_frames_;             // 不一致的帧数
+        bool finished_;
+    };
+
+} // namespace AutoAim
+
+#endif // GOLDEN_TRACE_HPP
\ No newline at end of file
@@ -1,17 +1,137 @@
 ﻿#include "LightBarDetector.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 
 namespace AutoAim {
 
+    namespace {
+        // 每个候选块最多核对的像素数
+        const int kBlobSamples = 64;
+
+        // 行程编码路径输出掩码：调用方接收行程编码时直接交出，否则展开为稠密掩码
+        void exportMask(RunMask& mask, cv::Mat* binary_out, RunMask* mask_out) {
+            if (mask_out != nullptr) {
+                std::swap(*mask_out, mask);
+            }
+            else if (binary_out != nullptr) {
+                *binary_out = mask.toMat();
+            }
+        }
+
+        // 按字节判断 >= thresh：低7位加偏置后检查最高位，字节间不产生进位
+        // 返回值每个字节最高位为1表示该字节不小于阈值
+        inline uint64_t bytesAtLeast(uint64_t word, int thresh) {
+            const uint64_t low = 0x7f7f7f7f7f7f7f7fULL;
+            if (thresh <= 128) {
+                return ((word & low) + 0x0101010101010101ULL * static_cast<uint64_t>(128 - thresh)) | word;
+            }
+            return ((word & low) + 0x0101010101010101ULL * static_cast<uint64_t>(256 - thresh)) & word;
+        }
+
+        // 一行中不小于阈值的字节所在的像素范围 [begin, end)，没有时 begin >= end
+        // 8字节一组跳过整组都暗的部分，只从两端找到第一个亮字节
+        void brightExtent(const uchar* row, int cols, int thresh, int& begin, int& end) {
+            const uint64_t high = 0x8080808080808080ULL;
+            const int bytes = cols * 3;
+            int first = 0;
+            while (first + 8 <= bytes) {
+                uint64_t w;
+                std::memcpy(&w, row + first, sizeof(w));
+                if (bytesAtLeast(w, thresh) & high) break;
+                first += 8;
+            }
+            while (first < bytes && row[first] < thresh) ++first;
+            if (first == bytes) {
+                begin = cols;
+                end = 0;
+                return;
+            }
+
+            int last = bytes;
+            while (last - 8 >= first) {
+                uint64_t w;
+                std::memcpy(&w, row + last - 8, sizeof(w));
+                if (bytesAtLeast(w, thresh) & high) break;
+                last -= 8;
+            }
+            while (row[last - 1] < thresh) --last;
+
+            begin = first / 3;
+            end = (last - 1) / 3 + 1;
+        }
+
+        // 外轮廓经过边界像素中心，面积不超过 (w-1)*(h-1)；据此不提取轮廓即可丢弃小连通域
+        bool contourAreaBelow(const cv::Rect& box, int min_area) {
+            return static_cast<int64_t>(box.width - 1) * (box.height - 1) < min_area;
+        }
+
+        // 标记位于其他连通域孔洞内的连通域：整帧 RETR_EXTERNAL 不会输出它们
+        std::vector<uchar> nestedComponents(const RunMask& mask, const std::vector<MaskComponent>& components) {
+            std::vector<uchar> nested(components.size(), 0);
+            for (size_t i = 0; i < components.size(); ++i) {
+                const cv::Rect& outer = components[i].box;
+                if (outer.width < 3 || outer.height < 3) {
+                    continue;
+                }
+                const cv::Rect interior(outer.x + 1, outer.y + 1, outer.width - 2, outer.height - 2);
+
+                cv::Mat filled;
+                for (size_t j = 0; j < components.size(); ++j) {
+                    const cv::Rect& inner = components[j].box;
+                    if (j == i || nested[j] || (inner & interior) != inner) {
+                        continue;
+                    }
+                    if (filled.empty()) {
+                        // 从外框按4邻接填充背景（与 findContours 的背景连通性一致），剩下的0即孔洞
+                        filled = mask.renderComponent(components[i], 1);
+                        cv::floodFill(filled, cv::Point(0, 0), cv::Scalar(128));
+                    }
+                    const MaskRun& run = mask.runs()[components[j].runs[0]];
+                    if (filled.at<uchar>(run.row - outer.y + 1, run.start - outer.x + 1) == 0) {
+                        nested[j] = 1;
+                    }
+                }
+            }
+            return nested;
+        }
+
+        // 单像素BGR转HSV（与 cv::COLOR_BGR2HSV 的8位结果一致到±1）
+        void pixelBGR2HSV(const uchar* p, int& h, int& s, int& v) {
+            int b = p[0], g = p[1], r = p[2];
+            v = std::max(std::max(b, g), r);
+            int diff = v - std::min(std::min(b, g), r);
+            s = v == 0 ? 0 : (diff * 255 + v / 2) / v;
+            if (diff == 0) {
+                h = 0;
+                return;
+            }
+            int h360;
+            if (v == r) h360 = 60 * (g - b) / diff;
+            else if (v == g) h360 = 120 + 60 * (b - r) / diff;
+            else h360 = 240 + 60 * (r - g) / diff;
+            if (h360 < 0) h360 += 360;
+            h = (h360 + 1) / 2;
+            if (h >= 180) h -= 180;
+        }
+    }
+
     LightBarDetector::LightBarDetector(const std::string& enemy_color)
         : enemy_color_(enemy_color),
         binary_threshold_(100),
+        saturation_threshold_(100),
         min_area_(50),
         max_area_(5000),
         min_aspect_ratio_(1.5),
         max_aspect_ratio_(15.0),
         min_angle_(0.0),
-        max_angle_(60.0) {
+        max_angle_(60.0),
+        yuv_luma_threshold_(50),
+        yuv_chroma_threshold_(25),
+        sparse_mask_(false),
+        brightness_first_(false) {
     }
 
     void LightBarDetector::setEnemyColor(const std::string& color) {
@@ -23,17 +143,124 @@ namespace AutoAim {
         min_area_ = area_thresh;
     }
 
+    void LightBarDetector::setColorThreshold(int saturation_thresh, int value_thresh) {
+        saturation_threshold_ = saturation_thresh;
+        binary_threshold_ = value_thresh;
+    }
+
+    void LightBarDetector::setShapeThreshold(int max_area, float min_aspect_ratio,
+        float max_aspect_ratio, float min_angle, float max_angle) {
+        max_area_ = max_area;
+        min_aspect_ratio_ = min_aspect_ratio;
+        max_aspect_ratio_ = max_aspect_ratio;
+        min_angle_ = min_angle;
+        max_angle_ = max_angle;
+    }
+
+    void LightBarDetector::setYUVThreshold(int luma_thresh, int chroma_thresh) {
+        yuv_luma_threshold_ = luma_thresh;
+        yuv_chroma_threshold_ = chroma_thresh;
+    }
+
     std::vector<cv::RotatedRect> LightBarDetector::detect(const cv::Mat& frame) {
-        // 预处理
-        cv::Mat processed = preprocess(frame);
+        return detect(frame, PixelFormat::BGR);
+    }
+
+    std::vector<cv::RotatedRect> LightBarDetector::detect(const cv::Mat& frame, PixelFormat format,
+        cv::Mat* binary_out, RunMask* mask_out) {
+        if (brightness_first_ && format == PixelFormat::BGR) {
+            RunMask mask = brightnessFirstSegmentation(frame);
+            mask.refine();
+            std::vector<cv::RotatedRect> light_bars = findLightBars(mask);
+            exportMask(mask, binary_out, mask_out);
+            return light_bars;
+        }
+
+        if (sparse_mask_) {
+            RunMask mask = sparseSegmentation(frame, format);
+            mask.refine();
+            std::vector<cv::RotatedRect> light_bars = findLightBars(mask);
+            exportMask(mask, binary_out, mask_out);
+            return light_bars;
+        }
+
+        cv::Mat binary;
+
+        if (format == PixelFormat::BGR) {
+            // 预处理
+            cv::Mat processed = preprocess(frame);
 
-        // 颜色分割
-        cv::Mat binary = colorSegmentation(processed);
+            // 颜色分割
+            binary = colorSegmentation(processed);
+        }
+        else {
+            // 直接在原始YUV数据上分割，跳过高斯模糊（交错的UV通道不能整体滤波）
+            binary = yuvSegmentation(frame, format);
+        }
+
+        if (binary_out != nullptr) {
+            *binary_out = binary;
+        }
 
         // 查找灯条
         return findLightBars(binary);
     }
 
+    std::vector<ColoredLightBar> LightBarDetector::detectColored(const cv::Mat& frame,
+        PixelFormat format, cv::Mat* labels_out) {
+        cv::Mat labels = labelSegmentation(frame, format);
+
+        // 形态学只处理前景，标签保持原样用于颜色判定
+        cv::Mat binary;
+        cv::threshold(labels, binary, 0, 255, cv::THRESH_BINARY);
+        refineMask(binary);
+
+        if (labels_out != nullptr) {
+            *labels_out = labels;
+        }
+
+        std::vector<ColoredLightBar> light_bars;
+        std::vector<std::vector<cv::Point>> contours;
+        cv::findContours(binary, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+
+        cv::Mat inside;
+        for (size_t i = 0; i < contours.size(); ++i) {
+            const auto& contour = contours[i];
+            double area = cv::contourArea(contour);
+            if (area < min_area_ || area > max_area_) {
+                continue;
+            }
+
+            cv::RotatedRect rect = cv::minAreaRect(contour);
+            if (!isValidLightBar(contour, rect)) {
+                continue;
+            }
+
+            // 只统计轮廓内部的红蓝像素，取多数：倾斜或相邻的灯条外接矩形会包含另一灯条的像素
+            cv::Rect box = cv::boundingRect(contour) & cv::Rect(0, 0, labels.cols, labels.rows);
+            inside.create(box.size(), CV_8UC1);
+            inside.setTo(cv::Scalar(0));
+            cv::drawContours(inside, contours, static_cast<int>(i), cv::Scalar(255), cv::FILLED,
+                cv::LINE_8, cv::noArray(), INT_MAX, -box.tl());
+            int red = 0, blue = 0;
+            for (int r = 0; r < box.height; ++r) {
+                const uchar* row = labels.ptr<uchar>(box.y + r) + box.x;
+                const uchar* in = inside.ptr<uchar>(r);
+                for (int c = 0; c < box.width; ++c) {
+                    red += in[c] && row[c] == static_cast<uchar>(LightColor::RED);
+                    blue += in[c] && row[c] == static_cast<uchar>(LightColor::BLUE);
+                }
+            }
+
+            ColoredLightBar bar;
+            bar.rect = rect;
+            bar.color = red >= blue ? LightColor::RED : LightColor::BLUE;
+            light_bars.push_back(bar);
+        }
+
+        return light_bars;
+    }
+
     cv::Mat LightBarDetector::preprocess(const cv::Mat& frame) {
         cv::Mat processed;
 
@@ -44,7 +271,15 @@ namespace AutoAim {
     }
 
     cv::Mat LightBarDetector::colorSegmentation(const cv::Mat& frame) {
+        if (color_lut_) {
+            cv::Mat binary = color_lut_->segment(frame, color());
+            refineMask(binary);
+            return binary;
+        }
+
         cv::Mat hsv, binary;
+        const int s_min = saturation_threshold_;
+        const int v_min = binary_threshold_;
 
         // 转换为HSV颜色空间
         cv::cvtColor(frame, hsv, cv::COLOR_BGR2HSV);
@@ -52,27 +287,375 @@ namespace AutoAim {
         if (enemy_color_ == "red") {
             // 红色有两个范围（0-10和160-180）
             cv::Mat red1, red2;
-            cv::inRange(hsv, cv::Scalar(0, 100, 100), cv::Scalar(10, 255, 255), red1);
-            cv::inRange(hsv, cv::Scalar(160, 100, 100), cv::Scalar(180, 255, 255), red2);
+            cv::inRange(hsv, cv::Scalar(0, s_min, v_min), cv::Scalar(10, 255, 255), red1);
+            cv::inRange(hsv, cv::Scalar(160, s_min, v_min), cv::Scalar(180, 255, 255), red2);
             binary = red1 | red2;
         }
         else if (enemy_color_ == "blue") {
             // 蓝色范围
-            cv::inRange(hsv, cv::Scalar(100, 100, 100), cv::Scalar(130, 255, 255), binary);
+            cv::inRange(hsv, cv::Scalar(100, s_min, v_min), cv::Scalar(130, 255, 255), binary);
         }
         else {
             // 默认使用红色
-            cv::inRange(hsv, cv::Scalar(0, 100, 100), cv::Scalar(10, 255, 255), binary);
+            cv::inRange(hsv, cv::Scalar(0, s_min, v_min), cv::Scalar(10, 255, 255), binary);
+        }
+
+        refineMask(binary);
+
+        return binary;
+    }
+
+    cv::Mat LightBarDetector::yuvSegmentation(const cv::Mat& frame, PixelFormat format) {
+        cv::Size size = Utils::frameSize(frame, format);
+        cv::Mat binary(size, CV_8UC1);
+        const bool red = (enemy_color_ != "blue");
+
+        for (int r = 0; r < size.height; ++r) {
+            yuvSegmentRow(frame, format, size, r, red, binary.ptr<uchar>(r));
+        }
+
+        refineMask(binary);
+
+        return binary;
+    }
+
+    void LightBarDetector::yuvSegmentRow(const cv::Mat& frame, PixelFormat format,
+        const cv::Size& size, int r, bool red, uchar* dst) const {
+        const int luma = yuv_luma_threshold_;
+        int c = 0;
+
+        if (format == PixelFormat::YUYV) {
+            // 每两个像素共享一组UV：Y0 U Y1 V
+            const uchar* src = frame.ptr<uchar>(r);
+            for (; c + 1 < size.width; c += 2, src += 4) {
+                bool chroma = isEnemyChroma(src[1], src[3], red);
+                dst[c] = (chroma && src[0] >= luma) ? 255 : 0;
+                dst[c + 1] = (chroma && src[2] >= luma) ? 255 : 0;
+            }
+        }
+        else {
+            // NV12：UV平面在Y平面之后，每2x2像素共享一组UV
+            const uchar* y = frame.ptr<uchar>(r);
+            const uchar* uv = frame.ptr<uchar>(size.height + r / 2);
+            for (; c + 1 < size.width; c += 2) {
+                bool chroma = isEnemyChroma(uv[c], uv[c + 1], red);
+                dst[c] = (chroma && y[c] >= luma) ? 255 : 0;
+                dst[c + 1] = (chroma && y[c + 1] >= luma) ? 255 : 0;
+            }
+        }
+
+        if (c < size.width) {
+            dst[c] = 0;
+        }
+    }
+
+    RunMask LightBarDetector::sparseSegmentation(const cv::Mat& frame, PixelFormat format) {
+        cv::Size size = Utils::frameSize(frame, format);
+        RunMask mask(size.height, size.width);
+        segmentRows(frame, format, 0, size.height, mask);
+        return mask;
+    }
+
+    void LightBarDetector::segmentRows(const cv::Mat& frame, PixelFormat format,
+        int first, int last, RunMask& mask) {
+        if (format == PixelFormat::BGR && color_lut_) {
+            // 查找表没有单独的亮度下限，仍需对全部行滤波
+            // ROI 滤波会使用父矩阵中相邻的行，分批结果与整帧一致
+            cv::Mat processed = preprocess(frame.rowRange(first, last));
+            std::vector<uchar> row(processed.cols);
+            for (int r = 0; r < processed.rows; ++r) {
+                color_lut_->classifyRow(processed.ptr<uchar>(r), processed.cols, color(), row.data());
+                mask.appendRow(row.data());
+            }
+            return;
+        }
+
+        if (format == PixelFormat::BGR) {
+            segmentBrightRegions(frame, first, last, mask);
+            return;
+        }
+
+        cv::Size size = Utils::frameSize(frame, format);
+        const bool red = (enemy_color_ != "blue");
+        std::vector<uchar> row(size.width);
+        for (int r = first; r < last; ++r) {
+            yuvSegmentRow(frame, format, size, r, red, row.data());
+            mask.appendRow(row.data());
+        }
+    }
+
+    void LightBarDetector::segmentBrightRegions(const cv::Mat& frame, int first, int last, RunMask& mask) {
+        const int thresh = std::min(std::max(binary_threshold_, 0), 255);
+        const int lo = std::max(first - 2, 0);
+        const int hi = std::min(last + 2, frame.rows);
+
+        // 各行亮字节的像素范围
+        std::vector<int> begin(hi - lo), end(hi - lo);
+        for (int r = lo; r < hi; ++r) {
+            brightExtent(frame.ptr<uchar>(r), frame.cols, thresh, begin[r - lo], end[r - lo]);
+        }
+
+        // 第 r 行 5x5 邻域内亮像素的列范围
+        auto window = [&](int r, int& c0, int& c1) {
+            c0 = frame.cols;
+            c1 = 0;
+            for (int k = std::max(r - 2, lo); k < std::min(r + 3, hi); ++k) {
+                c0 = std::min(c0, begin[k - lo]);
+                c1 = std::max(c1, end[k - lo]);
+            }
+        };
+
+        std::vector<uchar> row(frame.cols, 0);
+        int r = first;
+        while (r < last) {
+            int c0, c1;
+            window(r, c0, c1);
+            if (c0 >= c1) {
+                mask.endRow();
+                ++r;
+                continue;
+            }
+
+            // 连续的有效行合为一段，列范围取并集后外扩模糊半径
+            const int start = r;
+            int seg_c0 = c0, seg_c1 = c1;
+            for (++r; r < last; ++r) {
+                window(r, c0, c1);
+                if (c0 >= c1) {
+                    break;
+                }
+                seg_c0 = std::min(seg_c0, c0);
+                seg_c1 = std::max(seg_c1, c1);
+            }
+            seg_c0 = std::max(seg_c0 - 2, 0);
+            seg_c1 = std::min(seg_c1 + 2, frame.cols);
+
+            // ROI 滤波会使用父矩阵中相邻的像素，结果与整帧滤波一致
+            cv::Mat hsv;
+            cv::cvtColor(preprocess(frame(cv::Rect(seg_c0, start, seg_c1 - seg_c0, r - start))), hsv,
+                cv::COLOR_BGR2HSV);
+            for (int y = 0; y < hsv.rows; ++y) {
+                const uchar* src = hsv.ptr<uchar>(y);
+                uchar* dst = row.data() + seg_c0;
+                for (int c = 0; c < hsv.cols; ++c, src += 3) {
+                    dst[c] = isEnemyHSV(src[0], src[1], src[2]) ? 255 : 0;
+                }
+                mask.appendRow(row.data());
+            }
+            std::fill(row.begin() + seg_c0, row.begin() + seg_c1, 0);
+        }
+    }
+
+    RunMask LightBarDetector::brightnessFirstSegmentation(const cv::Mat& frame) {
+        // 第一阶段：HSV 的 V 即最大通道，亮度阈值与 HSV 路径一致，
+        // 每像素只有两次取最大和一次比较，不做模糊和颜色转换
+        // 8个像素（24字节）一组按字并行判断，整组都暗时直接跳过
+        RunMask bright(frame.rows, frame.cols);
+        std::vector<uchar> row(frame.cols);
+        const int thresh = std::min(std::max(binary_threshold_, 0), 255);
+        const uint64_t high = 0x8080808080808080ULL;
+        for (int r = 0; r < frame.rows; ++r) {
+            const uchar* src = frame.ptr<uchar>(r);
+            uchar* dst = row.data();
+            int c = 0;
+            for (; c + 8 <= frame.cols; c += 8) {
+                uint64_t w[3];
+                std::memcpy(w, src + 3 * c, sizeof(w));
+                uint64_t any = bytesAtLeast(w[0], thresh) | bytesAtLeast(w[1], thresh) |
+                    bytesAtLeast(w[2], thresh);
+                if ((any & high) == 0) {
+                    std::memset(dst + c, 0, 8);
+                    continue;
+                }
+                for (int k = c; k < c + 8; ++k) {
+                    uchar m = std::max(std::max(src[3 * k], src[3 * k + 1]), src[3 * k + 2]);
+                    dst[k] = m >= thresh ? 255 : 0;
+                }
+            }
+            for (; c < frame.cols; ++c) {
+                uchar m = std::max(std::max(src[3 * c], src[3 * c + 1]), src[3 * c + 2]);
+                dst[c] = m >= thresh ? 255 : 0;
+            }
+            bright.appendRow(dst);
+        }
+
+        // 第二阶段：逐块核对颜色，整块保留或丢弃
+        std::vector<uchar> keep(bright.runCount(), 0);
+        for (const auto& blob : bright.components()) {
+            // 宽或高不足3像素的块在开运算中会被完全腐蚀
+            if (blob.box.width < 3 || blob.box.height < 3) {
+                continue;
+            }
+            if (isEnemyBlob(frame, bright, blob)) {
+                for (int k : blob.runs) {
+                    keep[k] = 1;
+                }
+            }
+        }
+
+        RunMask mask(frame.rows, frame.cols);
+        const std::vector<MaskRun>& runs = bright.runs();
+        for (int r = 0; r < frame.rows; ++r) {
+            for (int k = bright.rowStart(r); k < bright.rowStart(r + 1); ++k) {
+                if (keep[k]) {
+                    mask.addRun(runs[k].start, runs[k].end);
+                }
+            }
+            mask.endRow();
+        }
+        return mask;
+    }
+
+    bool LightBarDetector::isEnemyBlob(const cv::Mat& frame, const RunMask& mask,
+        const MaskComponent& blob) const {
+        // 过曝的灯条中心接近白色，颜色集中在边缘一圈，
+        // 因此在整块上等间隔抽样，只统计饱和度足够的像素
+        const int step = std::max(1, blob.area / kBlobSamples);
+        int offset = 0;
+        int colored = 0, enemy = 0;
+        for (int k : blob.runs) {
+            const MaskRun& run = mask.runs()[k];
+            const uchar* src = frame.ptr<uchar>(run.row);
+            int c = run.start + offset;
+            for (; c < run.end; c += step) {
+                int h, s, v;
+                pixelBGR2HSV(src + 3 * c, h, s, v);
+                if (s >= saturation_threshold_) {
+                    ++colored;
+                    enemy += isEnemyHue(h) ? 1 : 0;
+                }
+            }
+            offset = c - run.end;
+        }
+        return colored > 0 && enemy * 2 > colored;
+    }
+
+    void LightBarDetector::beginStream(const cv::Size& size, PixelFormat format) {
+        stream_.format = format;
+        stream_.size = size;
+        stream_.segmented = 0;
+        stream_.tracked = 0;
+        stream_.raw.reset(size.height, size.width);
+        stream_.eroded.reset(size.height, size.width);
+        stream_.opened.reset(size.height, size.width);
+        stream_.refined.reset(size.height, size.width);
+        stream_.tracker.reset();
+    }
+
+    void LightBarDetector::pushRows(const cv::Mat& frame, int rows_ready,
+        std::vector<cv::RotatedRect>& light_bars) {
+        StreamState& s = stream_;
+        const int height = s.size.height;
+        const bool complete = (rows_ready >= frame.rows);
+
+        // 可分割的行：BGR 需要下方2行参与高斯模糊，NV12 需要整帧到达后的色度平面
+        int limit = std::min(rows_ready, height);
+        if (s.format == PixelFormat::BGR && !complete) {
+            limit = std::max(rows_ready - 2, 0);
+        }
+        else if (s.format == PixelFormat::NV12 && !complete) {
+            limit = 0;
+        }
+        if (limit > s.segmented) {
+            segmentRows(frame, s.format, s.segmented, limit, s.raw);
+            s.segmented = limit;
+        }
+
+        // 3x3 形态学每级需要下一行，输入整帧完成后按图像边界处理
+        auto advance = [height](const RunMask& in, RunMask& out, bool erode) {
+            while (out.rowsAppended() < in.rowsAppended()) {
+                int r = out.rowsAppended();
+                if (r + 1 >= in.rowsAppended() && in.rowsAppended() < height) break;
+                if (erode) in.erodeRow(r, out); else in.dilateRow(r, out);
+            }
+        };
+        advance(s.raw, s.eroded, true);
+        advance(s.eroded, s.opened, false);
+        advance(s.opened, s.refined, false);
+
+        s.closed.clear();
+        while (s.tracked < s.refined.rowsAppended()) {
+            s.tracker.addRow(s.refined, s.tracked++, s.closed);
+        }
+        if (s.tracked == height) {
+            s.tracker.finish(s.refined, s.closed);
+        }
+
+        for (const auto& component : s.closed) {
+            if (!contourAreaBelow(component.box, min_area_)) {
+                addComponent(s.refined, component, light_bars);
+            }
+        }
+    }
+
+    cv::Mat LightBarDetector::labelSegmentation(const cv::Mat& frame, PixelFormat format) {
+        if (format == PixelFormat::BGR && color_lut_) {
+            // 查表直接得到标签
+            return color_lut_->segment(preprocess(frame), LightColor::NONE);
+        }
+
+        if (format == PixelFormat::BGR) {
+            // 与单色路径相同的预处理和HSV转换，只做一次
+            cv::Mat hsv;
+            cv::cvtColor(preprocess(frame), hsv, cv::COLOR_BGR2HSV);
+
+            cv::Mat labels(hsv.size(), CV_8UC1);
+            for (int r = 0; r < hsv.rows; ++r) {
+                const uchar* src = hsv.ptr<uchar>(r);
+                uchar* dst = labels.ptr<uchar>(r);
+                for (int c = 0; c < hsv.cols; ++c, src += 3) {
+                    dst[c] = hsvLabel(src[0], src[1], src[2]);
+                }
+            }
+            return labels;
         }
 
+        cv::Size size = Utils::frameSize(frame, format);
+        cv::Mat labels(size, CV_8UC1);
+        const int luma = yuv_luma_threshold_;
+
+        if (format == PixelFormat::YUYV) {
+            for (int r = 0; r < size.height; ++r) {
+                const uchar* src = frame.ptr<uchar>(r);
+                uchar* dst = labels.ptr<uchar>(r);
+                int c = 0;
+                for (; c + 1 < size.width; c += 2, src += 4) {
+                    uchar label = chromaLabel(src[1], src[3]);
+                    dst[c] = src[0] >= luma ? label : 0;
+                    dst[c + 1] = src[2] >= luma ? label : 0;
+                }
+                if (c < size.width) {
+                    dst[c] = 0;
+                }
+            }
+        }
+        else {
+            for (int r = 0; r < size.height; ++r) {
+                const uchar* y = frame.ptr<uchar>(r);
+                const uchar* uv = frame.ptr<uchar>(size.height + r / 2);
+                uchar* dst = labels.ptr<uchar>(r);
+                int c = 0;
+                for (; c + 1 < size.width; c += 2) {
+                    uchar label = chromaLabel(uv[c], uv[c + 1]);
+                    dst[c] = y[c] >= luma ? label : 0;
+                    dst[c + 1] = y[c + 1] >= luma ? label : 0;
+                }
+                if (c < size.width) {
+                    dst[c] = 0;
+                }
+            }
+        }
+
+        return labels;
+    }
+
+    void LightBarDetector::refineMask(cv::Mat& binary) {
         // 形态学操作：先腐蚀后膨胀（开运算）
         cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
         cv::morphologyEx(binary, binary, cv::MORPH_OPEN, kernel);
 
         // 膨胀连接相近区域
         cv::dilate(binary, binary, kernel);
-
-        return binary;
     }
 
     std::vector<cv::RotatedRect> LightBarDetector::findLightBars(const cv::Mat& binary) {
@@ -83,24 +666,60 @@ namespace AutoAim {
         cv::findContours(binary, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
 
         for (const auto& contour : contours) {
-            // 轮廓面积
-            double area = cv::contourArea(contour);
-            if (area < min_area_ || area > max_area_) {
-                continue;
-            }
+            addLightBar(contour, light_bars);
+        }
 
-            // 最小外接旋转矩形
-            cv::RotatedRect rect = cv::minAreaRect(contour);
+        return light_bars;
+    }
 
-            // 筛选灯条
-            if (isValidLightBar(contour, rect)) {
-                light_bars.push_back(rect);
+    std::vector<cv::RotatedRect> LightBarDetector::findLightBars(const RunMask& mask) {
+        std::vector<cv::RotatedRect> light_bars;
+        std::vector<MaskComponent> components = mask.components();
+        std::vector<uchar> nested = nestedComponents(mask, components);
+
+        // findContours 按起点光栅序逆序输出，保持同样顺序
+        for (size_t k = components.size(); k-- > 0;) {
+            // 含孔洞时轮廓面积大于像素数，只能按外框上界提前丢弃
+            if (nested[k] || contourAreaBelow(components[k].box, min_area_)) {
+                continue;
             }
+
+            addComponent(mask, components[k], light_bars);
         }
 
         return light_bars;
     }
 
+    void LightBarDetector::addComponent(const RunMask& mask, const MaskComponent& component,
+        std::vector<cv::RotatedRect>& light_bars) {
+        // 只在连通域的局部掩码上提取轮廓（外扩1像素保证边界闭合）
+        cv::Mat roi = mask.renderComponent(component, 1);
+        std::vector<std::vector<cv::Point>> contours;
+        cv::findContours(roi, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE,
+            cv::Point(component.box.x - 1, component.box.y - 1));
+
+        for (const auto& contour : contours) {
+            addLightBar(contour, light_bars);
+        }
+    }
+
+    void LightBarDetector::addLightBar(const std::vector<cv::Point>& contour,
+        std::vector<cv::RotatedRect>& light_bars) {
+        // 轮廓面积
+        double area = cv::contourArea(contour);
+        if (area < min_area_ || area > max_area_) {
+            return;
+        }
+
+        // 最小外接旋转矩形
+        cv::RotatedRect rect = cv::minAreaRect(contour);
+
+        // 筛选灯条
+        if (isValidLightBar(contour, rect)) {
+            light_bars.push_back(rect);
+        }
+    }
+
     bool LightBarDetector::isValidLightBar(const std::vector<cv::Point>& contour,
         const cv::RotatedRect& rect) {
         // 计算长宽比
@@ -11,11 +11,20 @@
 #define LIGHT_BAR_DETECTOR_HPP
 
 #include <opencv2/opencv.hpp>
+#include <memory>
 #include <vector>
 #include "Utils.hpp"
+#include "ColorLut.hpp"
+#include "RunMask.hpp"
 
 namespace AutoAim {
 
+    // 带颜色标记的灯条（双色检测）
+    struct ColoredLightBar {
+        cv::RotatedRect rect;
+        LightColor color;
+    };
+
     class LightBarDetector {
     public:
         // 构造函数
@@ -24,10 +33,58 @@ namespace AutoAim {
         // 设置参数
         void setEnemyColor(const std::string& color);
         void setThreshold(int binary_thresh, int area_thresh);
+        void setYUVThreshold(int luma_thresh, int chroma_thresh);
+        int yuvChromaThreshold() const { return yuv_chroma_threshold_; }
+        void setColorThreshold(int saturation_thresh, int value_thresh);
+        void setShapeThreshold(int max_area, float min_aspect_ratio, float max_aspect_ratio,
+            float min_angle, float max_angle);
+
+        // 稀疏掩码模式：阈值化直接输出行程编码，形态学与连通域都在段上进行
+        void setSparseMask(bool enable) { sparse_mask_ = enable; }
+
+        // 亮度优先模式（BGR单色）：全帧只按最大通道做亮度阈值，
+        // 颜色只在得到的候选块内抽样核对，整块保留或丢弃
+        void setBrightnessFirst(bool enable) { brightness_first_ = enable; }
+
+        // 标定的颜色查找表：设置后BGR输入不再做HSV转换，每像素一次查表
+        void setColorLut(const std::shared_ptr<const ColorLut>& lut) { color_lut_ = lut; }
 
         // 检测灯条
         std::vector<cv::RotatedRect> detect(const cv::Mat& frame);
 
+        // 检测灯条（原生YUYV/NV12输入，直接在色度平面上分割，不转换BGR）
+        // binary 非空时输出分割掩码（回归测试用）；行程编码路径（稀疏、亮度优先）
+        // 在 mask 非空时改为输出行程编码，不再展开为稠密掩码
+        std::vector<cv::RotatedRect> detect(const cv::Mat& frame, PixelFormat format,
+            cv::Mat* binary = nullptr, RunMask* mask = nullptr);
+
+        // 双色检测：一次颜色转换得到标签掩码（0背景/1红/2蓝），
+        // 轮廓只提取一次，每个灯条按轮廓内部像素的多数标签标记颜色
+        // labels 非空时输出标签掩码
+        std::vector<ColoredLightBar> detectColored(const cv::Mat& frame, PixelFormat format,
+            cv::Mat* labels = nullptr);
+
+        // 流式检测：帧缓冲区自上而下写入时分批处理已到达的行
+        // 分割、形态学和连通域逐行推进，连通域一旦不会再增长就立即提取灯条
+        // 只支持单色模式；NV12 的色度平面在亮度之后到达，只能在整帧完成后处理
+        // 连通域封闭时无法知道它是否位于其他连通域的孔洞内，嵌套的连通域不会像整帧路径那样被排除
+        void beginStream(const cv::Size& size, PixelFormat format);
+
+        // frame 前 rows_ready 行（缓冲区行）已写入，新确定的灯条追加到 light_bars
+        // rows_ready == frame.rows 时结束本帧
+        void pushRows(const cv::Mat& frame, int rows_ready, std::vector<cv::RotatedRect>& light_bars);
+
+        // 流式检测的分割掩码（行程编码，本帧结束后完整）
+        const RunMask& streamMask() const { return stream_.refined; }
+
+        // 是否为双色模式（enemy_color == "both"）
+        bool isDualColor() const { return enemy_color_ == "both"; }
+
+        // 单色模式下的灯条颜色
+        LightColor color() const {
+            return enemy_color_ == "blue" ? LightColor::BLUE : LightColor::RED;
+        }
+
         // 预处理
         cv::Mat preprocess(const cv::Mat& frame);
 
@@ -35,21 +92,113 @@ namespace AutoAim {
         // 颜色分割
         cv::Mat colorSegmentation(const cv::Mat& frame);
 
+        // YUV颜色分割：亮度 + 色度阈值
+        cv::Mat yuvSegmentation(const cv::Mat& frame, PixelFormat format);
+
+        // 分割一行YUV像素（YUYV/NV12）
+        void yuvSegmentRow(const cv::Mat& frame, PixelFormat format, const cv::Size& size,
+            int r, bool red, uchar* dst) const;
+
+        // 稀疏分割：逐行阈值化后直接编码为行程
+        RunMask sparseSegmentation(const cv::Mat& frame, PixelFormat format);
+
+        // 分割 [first, last) 行并追加到 mask；BGR 的高斯模糊在整帧缓冲区的ROI上进行，
+        // 边界行会读取上下各2行，调用者需保证这些行已到达
+        void segmentRows(const cv::Mat& frame, PixelFormat format, int first, int last, RunMask& mask);
+
+        // BGR的HSV分割只处理亮区域：模糊后每个通道不超过5x5邻域内原值的最大值，
+        // 邻域内没有字节达到亮度阈值的像素不可能通过，跳过其模糊和颜色转换，结果与整帧处理一致
+        void segmentBrightRegions(const cv::Mat& frame, int first, int last, RunMask& mask);
+
+        // 亮度优先分割：最大通道阈值化 + 候选块颜色核对
+        RunMask brightnessFirstSegmentation(const cv::Mat& frame);
+
+        // 候选块是否为敌方颜色：抽样像素中饱和度足够的按色调投票
+        bool isEnemyBlob(const cv::Mat& frame, const RunMask& mask, const MaskComponent& blob) const;
+
+        // 标签分割：同一次遍历同时判断红、蓝
+        cv::Mat labelSegmentation(const cv::Mat& frame, PixelFormat format);
+
+        // 掩码形态学处理
+        void refineMask(cv::Mat& binary);
+
+        // 判断色度是否为敌方颜色（U=Cb, V=Cr）
+        bool isEnemyChroma(int u, int v, bool red) const {
+            int cb = u - 128;
+            int cr = v - 128;
+            return red ? (cr >= yuv_chroma_threshold_ && cr > cb)
+                       : (cb >= yuv_chroma_threshold_ && cb > cr);
+        }
+
+        // 色度标签，红蓝两个判断互斥
+        uchar chromaLabel(int u, int v) const {
+            int cb = u - 128;
+            int cr = v - 128;
+            if (cr >= yuv_chroma_threshold_ && cr > cb) return static_cast<uchar>(LightColor::RED);
+            if (cb >= yuv_chroma_threshold_ && cb > cr) return static_cast<uchar>(LightColor::BLUE);
+            return 0;
+        }
+
+        // HSV是否在敌方颜色范围内（与colorSegmentation一致）
+        bool isEnemyHSV(int h, int s, int v) const {
+            if (s < saturation_threshold_ || v < binary_threshold_) return false;
+            return isEnemyHue(h);
+        }
+
+        bool isEnemyHue(int h) const {
+            if (enemy_color_ == "blue") return h >= 100 && h <= 130;
+            return h <= 10 || h >= 160;
+        }
+
+        // HSV标签（与colorSegmentation的范围一致）
+        uchar hsvLabel(int h, int s, int v) const {
+            if (s < saturation_threshold_ || v < binary_threshold_) return 0;
+            if (h <= 10 || h >= 160) return static_cast<uchar>(LightColor::RED);
+            if (h >= 100 && h <= 130) return static_cast<uchar>(LightColor::BLUE);
+            return 0;
+        }
+
         // 轮廓检测与筛选
         std::vector<cv::RotatedRect> findLightBars(const cv::Mat& binary);
+        std::vector<cv::RotatedRect> findLightBars(const RunMask& mask);
+
+        // 从单个连通域提取轮廓并筛选
+        void addComponent(const RunMask& mask, const MaskComponent& component,
+            std::vector<cv::RotatedRect>& light_bars);
+
+        // 按面积和形状筛选单个轮廓
+        void addLightBar(const std::vector<cv::Point>& contour, std::vector<cv::RotatedRect>& light_bars);
 
         // 筛选灯条轮廓
         bool isValidLightBar(const std::vector<cv::Point>& contour, const cv::RotatedRect& rect);
 
     private:
         std::string enemy_color_;      // 敌方颜色
-        int binary_threshold_;         // 二值化阈值
+        int binary_threshold_;         // 二值化阈值（HSV亮度下限）
+        int saturation_threshold_;     // HSV饱和度下限
         int min_area_;                 // 最小面积阈值
         int max_area_;                 // 最大面积阈值
         float min_aspect_ratio_;       // 最小长宽比
         float max_aspect_ratio_;       // 最大长宽比
         float min_angle_;              // 最小角度（绝对值）
         float max_angle_;              // 最大角度（绝对值）
+        int yuv_luma_threshold_;       // YUV路径亮度阈值
+        int yuv_chroma_threshold_;     // YUV路径色度阈值（相对128）
+        bool sparse_mask_;             // 是否使用行程编码掩码
+        bool brightness_first_;        // 是否先亮度阈值、后核对颜色
+        std::shared_ptr<const ColorLut> color_lut_;    // 颜色查找表，为空时使用HSV阈值
+
+        // 流式检测状态：原始掩码经腐蚀、膨胀、膨胀逐级滞后一行
+        struct StreamState {
+            PixelFormat format;
+            cv::Size size;
+            int segmented;              // 已分割的行数
+            int tracked;                // 已送入连通域跟踪的行数
+            RunMask raw, eroded, opened, refined;
+            ComponentTracker tracker;
+            std::vector<MaskComponent> closed;
+        };
+        StreamState stream_;
     };
 
 } // namespace AutoAim
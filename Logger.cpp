@@ -0,0 +1,272 @@
+﻿#include "Logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace AutoAim {
+
+    namespace {
+        inline int64_t steadyNowNs() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        const char* levelName(LogLevel level) {
+            switch (level) {
+            case LogLevel::Debug: return "DEBUG";
+            case LogLevel::Info:  return "INFO";
+            case LogLevel::Warn:  return "WARN";
+            case LogLevel::Error: return "ERROR";
+            }
+            return "?";
+        }
+
+        // 线程局部缓冲区指针（环形缓冲区由Logger持有，线程退出后仍有效）
+        thread_local void* t_ring = nullptr;
+    }
+
+    Logger& Logger::instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    Logger::Logger()
+        : running_(true), flush_requests_(0), flush_done_(0),
+        progress_(-1), printed_progress_(-1), last_progress_ns_(0),
+        progress_interval_ns_(200 * 1000000LL), dropped_(0) {
+        steady_base_ns_ = steadyNowNs();
+        wall_base_ms_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        thread_ = std::thread(&Logger::run, this);
+    }
+
+    Logger::~Logger() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cond_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    Logger::Ring* Logger::threadRing() {
+        Ring* ring = static_cast<Ring*>(t_ring);
+        if (!ring) {
+            std::unique_ptr<Ring> created(new Ring());
+            ring = created.get();
+            std::lock_guard<std::mutex> lock(rings_mutex_);
+            rings_.push_back(std::move(created));
+            t_ring = ring;
+        }
+        return ring;
+    }
+
+    LogRecord* Logger::beginRecord(Ring*& ring, LogLevel level) {
+        ring = threadRing();
+        uint64_t head = ring->head.load(std::memory_order_relaxed);
+        if (head - ring->tail.load(std::memory_order_acquire) >= kRingSize) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        LogRecord* record = &ring->records[head % kRingSize];
+        record->timestamp_ns = steadyNowNs();
+        record->level = level;
+        record->format = nullptr;
+        record->arg_count = 0;
+        record->text_len = 0;
+        record->heap_text = nullptr;
+        return record;
+    }
+
+    void Logger::commitRecord(Ring* ring) {
+        ring->head.store(ring->head.load(std::memory_order_relaxed) + 1,
+            std::memory_order_release);
+    }
+
+    void Logger::log(LogLevel level, const char* format) {
+        Ring* ring;
+        LogRecord* record = beginRecord(ring, level);
+        if (!record) return;
+        record->format = format;
+        commitRecord(ring);
+    }
+
+    void Logger::log(LogLevel level, const char* format, int64_t a) {
+        Ring* ring;
+        LogRecord* record = beginRecord(ring, level);
+        if (!record) return;
+        record->format = format;
+        record->args[0] = a;
+        record->arg_count = 1;
+        commitRecord(ring);
+    }
+
+    void Logger::log(LogLevel level, const char* format, int64_t a, int64_t b) {
+        Ring* ring;
+        LogRecord* record = beginRecord(ring, level);
+        if (!record) return;
+        record->format = format;
+        record->args[0] = a;
+        record->args[1] = b;
+        record->arg_count = 2;
+        commitRecord(ring);
+    }
+
+    void Logger::log(LogLevel level, const char* format, int64_t a, int64_t b, int64_t c, int64_t d) {
+        Ring* ring;
+        LogRecord* record = beginRecord(ring, level);
+        if (!record) return;
+        record->format = format;
+        record->args[0] = a;
+        record->args[1] = b;
+        record->args[2] = c;
+        record->args[3] = d;
+        record->arg_count = 4;
+        commitRecord(ring);
+    }
+
+    void Logger::logText(LogLevel level, const std::string& message) {
+        Ring* ring;
+        LogRecord* record = beginRecord(ring, level);
+        if (!record) return;
+        if (message.size() < sizeof(record->text)) {
+            std::memcpy(record->text, message.data(), message.size());
+            record->text_len = static_cast<uint8_t>(message.size());
+        }
+        else {
+            // 长消息完整保留，由后台线程输出后释放；不截断，也就不必关心编码
+            char* copy = new char[message.size() + 1];
+            std::memcpy(copy, message.c_str(), message.size() + 1);
+            record->heap_text = copy;
+        }
+        commitRecord(ring);
+    }
+
+    void Logger::flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!running_) return;
+        uint64_t ticket = ++flush_requests_;
+        cond_.notify_all();
+        flushed_.wait(lock, [&] { return flush_done_ >= ticket || !running_; });
+    }
+
+    std::string Logger::formatRecord(const LogRecord& record) const {
+        // 单调时钟换算为墙上时间，只在后台线程进行
+        int64_t wall_ms = wall_base_ms_ + (record.timestamp_ns - steady_base_ns_) / 1000000;
+        std::time_t seconds = static_cast<std::time_t>(wall_ms / 1000);
+        std::tm tm_buf;
+#ifdef _WIN32
+        localtime_s(&tm_buf, &seconds);
+#else
+        localtime_r(&seconds, &tm_buf);
+#endif
+        std::ostringstream out;
+        out << "[" << std::put_time(&tm_buf, "%H:%M:%S") << "."
+            << std::setfill('0') << std::setw(3) << (wall_ms % 1000) << "] ";
+        if (record.level != LogLevel::Info) {
+            out << levelName(record.level) << ": ";
+        }
+
+        if (!record.format) {
+            if (record.heap_text) {
+                out << record.heap_text;
+            }
+            else {
+                out.write(record.text, record.text_len);
+            }
+            return out.str();
+        }
+
+        int arg = 0;
+        for (const char* p = record.format; *p; ++p) {
+            if (p[0] == '{' && p[1] == '}' && arg < record.arg_count) {
+                out << record.args[arg++];
+                ++p;
+            }
+            else {
+                out << *p;
+            }
+        }
+        return out.str();
+    }
+
+    bool Logger::drain() {
+        std::vector<Ring*> rings;
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex_);
+            for (const auto& ring : rings_) {
+                rings.push_back(ring.get());
+            }
+        }
+
+        bool any = false;
+        for (Ring* ring : rings) {
+            uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            for (; tail != head; ++tail) {
+                const LogRecord& record = ring->records[tail % kRingSize];
+                if (!any && printed_progress_ >= 0) {
+                    std::cout << "\n";      // 结束进度行
+                    printed_progress_ = -1;
+                }
+                std::ostream& stream = record.level >= LogLevel::Warn ? std::cerr : std::cout;
+                stream << formatRecord(record) << "\n";
+                delete[] record.heap_text;
+                any = true;
+            }
+            ring->tail.store(tail, std::memory_order_release);
+        }
+        if (any) {
+            std::cout.flush();
+            std::cerr.flush();
+        }
+        return any;
+    }
+
+    void Logger::printProgress(bool force) {
+        int64_t frame = progress_.load(std::memory_order_relaxed);
+        if (frame < 0 || frame == printed_progress_) return;
+
+        int64_t now = steadyNowNs();
+        if (!force && now - last_progress_ns_ < progress_interval_ns_) return;
+
+        std::cout << "处理帧: " << frame << "\r" << std::flush;
+        printed_progress_ = frame;
+        last_progress_ns_ = now;
+    }
+
+    void Logger::run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cond_.wait_for(lock, std::chrono::milliseconds(10));
+            bool running = running_;
+            uint64_t requests = flush_requests_;
+            lock.unlock();
+
+            drain();
+            bool flushing = requests != flush_done_ || !running;
+            printProgress(flushing);
+            if (flushing && printed_progress_ >= 0) {
+                std::cout << "\n" << std::flush;
+                printed_progress_ = -1;
+                progress_.store(-1, std::memory_order_relaxed);
+            }
+
+            lock.lock();
+            flush_done_ = requests;
+            flushed_.notify_all();
+            if (!running) break;
+        }
+        uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped > 0) {
+            std::cerr << "警告: 日志缓冲区已满，丢弃 " << dropped << " 条记录" << std::endl;
+        }
+    }
+
+} // namespace AutoAim
\ No newline at end of file
@@ -0,0 +1,115 @@
+﻿#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace AutoAim {
+
+    enum class LogLevel : uint8_t {
+        Debug,      // 不用全大写，避免与 Windows 的 ERROR 宏冲突
+        Info,
+        Warn,
+        Error
+    };
+
+    // 定长二进制日志记录（128字节）
+    struct LogRecord {
+        int64_t timestamp_ns;       // 单调时钟
+        const char* format;         // 字符串字面量，"{}"为参数占位；为空时使用text
+        int64_t args[4];
+        LogLevel level;
+        uint8_t arg_count;
+        uint8_t text_len;
+        uint8_t reserved[5];
+        const char* heap_text;      // 不短于 text 的消息：完整拷贝到堆上，输出后释放
+        char text[64];              // 拷贝的短消息
+    };
+
+    // 异步日志：热路径只写入本线程的无锁环形缓冲区（单生产者单消费者），
+    // 后台线程负责格式化、加时间戳和输出，进度信息限速输出
+    class Logger {
+    public:
+        static Logger& instance();
+
+        ~Logger();
+
+        // format 必须是字符串字面量（只保存指针），按字节只匹配ASCII的 "{}"，不解析多字节字符：
+        // UTF-8 的多字节序列都 >=0x80，GBK 只有次字节为 '{' 的字符紧跟 '}' 才会误认，格式串中不应出现
+        void log(LogLevel level, const char* format);
+        void log(LogLevel level, const char* format, int64_t a);
+        void log(LogLevel level, const char* format, int64_t a, int64_t b);
+        void log(LogLevel level, const char* format, int64_t a, int64_t b, int64_t c, int64_t d = 0);
+
+        // 拷贝任意消息：短于64字节的放在记录内，更长的完整拷贝到堆上（不截断）
+        void logText(LogLevel level, const std::string& message);
+
+        // 更新进度（处理帧号），后台线程按 progress_interval_ms 限速刷新
+        void progress(int64_t frame) { progress_.store(frame, std::memory_order_relaxed); }
+
+        // 等待所有已写入的记录输出完毕，并结束进度行
+        void flush();
+
+        // 丢弃的记录数（环形缓冲区满）
+        uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+        static const size_t kRingSize = 1024;
+
+        // 单线程写、后台线程读的环形缓冲区
+        struct Ring {
+            Ring() : head(0), tail(0) {}
+            std::atomic<uint64_t> head;     // 写位置（生产者）
+            std::atomic<uint64_t> tail;     // 读位置（消费者）
+            LogRecord records[kRingSize];
+        };
+
+        Logger();
+
+        // 当前线程的缓冲区，首次调用时注册
+        Ring* threadRing();
+
+        // 申请一条记录，满时返回空
+        LogRecord* beginRecord(Ring*& ring, LogLevel level);
+        void commitRecord(Ring* ring);
+
+        // 后台线程
+        void run();
+        bool drain();
+        void printProgress(bool force);
+        std::string formatRecord(const LogRecord& record) const;
+
+        Logger(const Logger&);
+        Logger& operator=(const Logger&);
+
+    private:
+        std::mutex rings_mutex_;
+        std::vector<std::unique_ptr<Ring>> rings_;
+
+        std::thread thread_;
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        std::condition_variable flushed_;
+        bool running_;
+        uint64_t flush_requests_;
+        uint64_t flush_done_;
+
+        std::atomic<int64_t> progress_;
+        int64_t printed_progress_;
+        int64_t last_progress_ns_;
+        int64_t progress_interval_ns_;
+        std::atomic<uint64_t> dropped_;
+
+        int64_t steady_base_ns_;    // 启动时单调时钟
+        int64_t wall_base_ms_;      // 启动时墙上时间（毫秒）
+    };
+
+} // namespace AutoAim
+
+#endif // LOGGER_HPP
\ No newline at end of file
@@ -0,0 +1,320 @@
+﻿#include "ModelBundle.hpp"
+#include "ArmorDetector.hpp"
+#include "NumberRecognizer.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace AutoAim {
+
+    namespace {
+        const char kBundleMagic[4] = { 'A', 'A', 'B', 'D' };
+        const uint32_t kBundleVersion = 1;
+
+        // 文件头，之后依次为 int32 标签数组和 uint8 模板数据（均8字节对齐）
+        struct BundleHeader {
+            char magic[4];
+            uint32_t version;
+            uint32_t header_size;
+            uint32_t template_count;
+            uint32_t template_rows;
+            uint32_t template_cols;
+            uint64_t labels_offset;
+            uint64_t templates_offset;
+            uint64_t file_size;
+            uint32_t has_calibration;
+            uint32_t content_hash;      // 本字段置0后整个文件的FNV-1a；0 表示未记录（旧文件）
+            double camera_matrix[9];
+            double dist_coeffs[5];
+            BundleParams params;
+        };
+
+        static_assert(sizeof(BundleHeader) % 8 == 0, "bundle header must not have tail padding");
+
+        uint64_t align8(uint64_t value) {
+            return (value + 7) & ~static_cast<uint64_t>(7);
+        }
+
+        uint32_t fnv1a(const void* data, size_t size, uint32_t hash = 2166136261u) {
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; ++i) {
+                hash = (hash ^ p[i]) * 16777619u;
+            }
+            return hash;
+        }
+
+        uint32_t contentHash(const BundleHeader& header, const unsigned char* payload, size_t payload_size) {
+            BundleHeader copy = header;
+            copy.content_hash = 0;
+            uint32_t hash = fnv1a(payload, payload_size, fnv1a(&copy, sizeof(copy)));
+            return hash != 0 ? hash : 1;
+        }
+    }
+
+    ModelBundle::ModelBundle() : data_(nullptr), size_(0), handle_(nullptr) {
+    }
+
+    ModelBundle::~ModelBundle() {
+        unmap();
+    }
+
+    bool ModelBundle::load(const std::string& path) {
+        unmap();
+
+#ifdef _WIN32
+        // 允许其他进程在映射期间替换文件（ModelBundle::write 的 MoveFileEx），否则热重载无法写入
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            std::cerr << "错误: 无法打开bundle文件 " << path << std::endl;
+            return false;
+        }
+        LARGE_INTEGER file_size;
+        GetFileSizeEx(file, &file_size);
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            std::cerr << "错误: 无法映射bundle文件 " << path << std::endl;
+            return false;
+        }
+        void* addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (addr == nullptr) {
+            CloseHandle(mapping);
+            std::cerr << "错误: 无法映射bundle文件 " << path << std::endl;
+            return false;
+        }
+        handle_ = mapping;
+        size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "错误: 无法打开bundle文件 " << path << std::endl;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            std::cerr << "错误: bundle文件为空 " << path << std::endl;
+            return false;
+        }
+        void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            std::cerr << "错误: 无法映射bundle文件 " << path << std::endl;
+            return false;
+        }
+        size_ = static_cast<size_t>(st.st_size);
+#endif
+        data_ = static_cast<const unsigned char*>(addr);
+
+        // 校验文件头
+        const BundleHeader* header = reinterpret_cast<const BundleHeader*>(data_);
+        if (size_ < sizeof(BundleHeader) || std::memcmp(header->magic, kBundleMagic, 4) != 0 ||
+            header->version != kBundleVersion || header->header_size != sizeof(BundleHeader) ||
+            header->file_size != size_) {
+            std::cerr << "错误: bundle文件格式或版本不匹配 " << path << std::endl;
+            unmap();
+            return false;
+        }
+
+        uint64_t template_bytes = static_cast<uint64_t>(header->template_rows) * header->template_cols;
+        if (header->labels_offset + header->template_count * sizeof(int32_t) > size_ ||
+            header->templates_offset + header->template_count * template_bytes > size_) {
+            std::cerr << "错误: bundle文件已损坏 " << path << std::endl;
+            unmap();
+            return false;
+        }
+
+        if (header->content_hash != 0 &&
+            contentHash(*header, data_ + sizeof(BundleHeader), size_ - sizeof(BundleHeader)) != header->content_hash) {
+            std::cerr << "错误: bundle文件校验失败 " << path << std::endl;
+            unmap();
+            return false;
+        }
+
+        params_ = header->params;
+
+        // 模板：直接包装映射内存，不拷贝
+        const int32_t* labels = reinterpret_cast<const int32_t*>(data_ + header->labels_offset);
+        unsigned char* pixels = const_cast<unsigned char*>(data_ + header->templates_offset);
+        for (uint32_t i = 0; i < header->template_count; ++i) {
+            templates_.push_back(cv::Mat(header->template_rows, header->template_cols, CV_8UC1,
+                pixels + i * template_bytes));
+            labels_.push_back(labels[i]);
+        }
+
+        if (header->has_calibration) {
+            camera_matrix_ = cv::Mat(3, 3, CV_64F, const_cast<double*>(header->camera_matrix));
+            dist_coeffs_ = cv::Mat(1, 5, CV_64F, const_cast<double*>(header->dist_coeffs));
+        }
+
+        std::cout << "已加载bundle: " << path << " (" << templates_.size() << " 个模板)" << std::endl;
+        return true;
+    }
+
+    bool ModelBundle::write(const std::string& path, const BundleParams& params,
+        const std::vector<cv::Mat>& templates, const std::vector<int>& labels,
+        const cv::Mat& camera_matrix, const cv::Mat& dist_coeffs) {
+        if (templates.empty() || templates.size() != labels.size()) {
+            std::cerr << "错误: 模板为空或与标签数量不一致" << std::endl;
+            return false;
+        }
+
+        BundleHeader header = BundleHeader();
+        std::memcpy(header.magic, kBundleMagic, 4);
+        header.version = kBundleVersion;
+        header.header_size = sizeof(BundleHeader);
+        header.template_count = static_cast<uint32_t>(templates.size());
+        header.template_rows = templates[0].rows;
+        header.template_cols = templates[0].cols;
+        header.labels_offset = align8(sizeof(BundleHeader));
+        header.templates_offset = align8(header.labels_offset + templates.size() * sizeof(int32_t));
+        header.file_size = header.templates_offset +
+            templates.size() * header.template_rows * header.template_cols;
+        header.params = params;
+
+        if (camera_matrix.total() == 9 && dist_coeffs.total() >= 5) {
+            cv::Mat k, d;
+            camera_matrix.convertTo(k, CV_64F);
+            dist_coeffs.convertTo(d, CV_64F);
+            std::memcpy(header.camera_matrix, k.ptr<double>(), sizeof(header.camera_matrix));
+            std::memcpy(header.dist_coeffs, d.ptr<double>(), sizeof(header.dist_coeffs));
+            header.has_calibration = 1;
+        }
+
+        // 文件头之后的内容先在内存中组装，算出内容哈希后一次写出
+        std::vector<unsigned char> payload(header.file_size - sizeof(BundleHeader), 0);
+        unsigned char* labels_out = payload.data() + (header.labels_offset - sizeof(BundleHeader));
+        for (size_t i = 0; i < labels.size(); ++i) {
+            int32_t value = labels[i];
+            std::memcpy(labels_out + i * sizeof(int32_t), &value, sizeof(value));
+        }
+
+        const size_t template_bytes = static_cast<size_t>(header.template_rows) * header.template_cols;
+        unsigned char* templates_out = payload.data() + (header.templates_offset - sizeof(BundleHeader));
+        for (size_t i = 0; i < templates.size(); ++i) {
+            const cv::Mat& t = templates[i];
+            if (t.rows != static_cast<int>(header.template_rows) ||
+                t.cols != static_cast<int>(header.template_cols) || t.type() != CV_8UC1) {
+                std::cerr << "错误: 模板尺寸或类型不一致" << std::endl;
+                return false;
+            }
+            for (int r = 0; r < t.rows; ++r) {
+                std::memcpy(templates_out + i * template_bytes + static_cast<size_t>(r) * t.cols, t.ptr(r), t.cols);
+            }
+        }
+        header.content_hash = contentHash(header, payload.data(), payload.size());
+
+        // 先写临时文件再替换：运行中的进程映射着旧文件，原地改写会使其模板内容失效
+        const std::string tmp_path = path + ".tmp";
+        std::ofstream out(tmp_path, std::ios::binary);
+        if (!out) {
+            std::cerr << "错误: 无法创建bundle文件 " << tmp_path << std::endl;
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+        out.close();
+        if (!out) {
+            std::cerr << "错误: 写入bundle文件失败 " << tmp_path << std::endl;
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+
+#ifdef _WIN32
+        bool replaced = MoveFileExA(tmp_path.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        bool replaced = std::rename(tmp_path.c_str(), path.c_str()) == 0;
+#endif
+        if (!replaced) {
+            std::cerr << "错误: 无法替换bundle文件 " << path << std::endl;
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+
+        std::cout << "bundle已写出: " << path << " (" << header.file_size << " 字节)" << std::endl;
+        return true;
+    }
+
+    bool ModelBundle::readContentHash(const std::string& path, uint32_t& hash) {
+        BundleHeader header;
+#ifdef _WIN32
+        // 与 load 相同的共享方式，轮询时不妨碍写入方替换文件
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        DWORD bytes = 0;
+        BOOL ok = ReadFile(file, &header, sizeof(header), &bytes, nullptr);
+        CloseHandle(file);
+        if (!ok || bytes != sizeof(header)) {
+            return false;
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        ssize_t bytes = ::read(fd, &header, sizeof(header));
+        ::close(fd);
+        if (bytes != static_cast<ssize_t>(sizeof(header))) {
+            return false;
+        }
+#endif
+        if (std::memcmp(header.magic, kBundleMagic, 4) != 0) {
+            return false;
+        }
+        hash = header.content_hash;
+        return true;
+    }
+
+    void ModelBundle::apply(LightBarDetector& light_detector, ArmorDetector& armor_detector,
+        NumberRecognizer& number_recognizer) const {
+        const BundleParams& p = params_;
+        light_detector.setThreshold(p.binary_threshold, p.min_area);
+        light_detector.setColorThreshold(p.saturation_threshold, p.binary_threshold);
+        light_detector.setShapeThreshold(p.max_area, p.min_aspect_ratio, p.max_aspect_ratio,
+            p.min_angle, p.max_angle);
+        light_detector.setYUVThreshold(p.yuv_luma_threshold, p.yuv_chroma_threshold);
+        armor_detector.setPairThreshold(p.max_height_ratio, p.max_angle_diff,
+            p.min_distance_ratio, p.max_distance_ratio);
+        number_recognizer.setBinaryThreshold(p.number_threshold);
+        number_recognizer.setConfidenceThreshold(p.number_confidence);
+        number_recognizer.setTemplates(templates_, labels_);
+    }
+
+    void ModelBundle::unmap() {
+        templates_.clear();
+        labels_.clear();
+        camera_matrix_.release();
+        dist_coeffs_.release();
+
+        if (data_ == nullptr) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+        CloseHandle(static_cast<HANDLE>(handle_));
+        handle_ = nullptr;
+#else
+        munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+} // namespace AutoAim
\ No newline at end of file
@@ -0,0 +1,100 @@
+﻿#ifndef MODEL_BUNDLE_HPP
+#define MODEL_BUNDLE_HPP
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace AutoAim {
+
+    class LightBarDetector;
+    class ArmorDetector;
+    class NumberRecognizer;
+
+    // 检测器参数（文件中按此布局存储）
+    // 默认值与各检测器构造函数一致
+    struct BundleParams {
+        // LightBarDetector
+        int32_t binary_threshold;
+        int32_t saturation_threshold;
+        int32_t min_area;
+        int32_t max_area;
+        float min_aspect_ratio;
+        float max_aspect_ratio;
+        float min_angle;
+        float max_angle;
+        int32_t yuv_luma_threshold;
+        int32_t yuv_chroma_threshold;
+        // ArmorDetector
+        float max_height_ratio;
+        float max_angle_diff;
+        float min_distance_ratio;
+        float max_distance_ratio;
+        // NumberRecognizer
+        int32_t number_threshold;
+        float number_confidence;
+
+        BundleParams()
+            : binary_threshold(100), saturation_threshold(100), min_area(50), max_area(5000),
+            min_aspect_ratio(1.5f), max_aspect_ratio(15.0f), min_angle(0.0f), max_angle(60.0f),
+            yuv_luma_threshold(50), yuv_chroma_threshold(25),
+            max_height_ratio(2.0f), max_angle_diff(20.0f), min_distance_ratio(0.5f), max_distance_ratio(4.0f),
+            number_threshold(100), number_confidence(0.7f) {
+        }
+    };
+
+    // 单文件模型/配置包：预处理好的数字模板、检测器参数、相机标定
+    // 启动时一次mmap，模板直接引用映射内存，不做图像解码
+    class ModelBundle {
+    public:
+        ModelBundle();
+        ~ModelBundle();
+
+        // 映射并校验bundle文件
+        bool load(const std::string& path);
+
+        // 写出bundle文件
+        static bool write(const std::string& path, const BundleParams& params,
+            const std::vector<cv::Mat>& templates, const std::vector<int>& labels,
+            const cv::Mat& camera_matrix, const cv::Mat& dist_coeffs);
+
+        bool isLoaded() const { return data_ != nullptr; }
+
+        // 只读文件头中的内容哈希（不映射），用于检测文件是否被替换
+        static bool readContentHash(const std::string& path, uint32_t& hash);
+
+        const BundleParams& params() const { return params_; }
+
+        // 将参数与模板设置到各检测器
+        void apply(LightBarDetector& light_detector, ArmorDetector& armor_detector,
+            NumberRecognizer& number_recognizer) const;
+
+        // 模板直接包装映射内存，bundle销毁前有效
+        const std::vector<cv::Mat>& templates() const { return templates_; }
+        const std::vector<int>& labels() const { return labels_; }
+
+        // 相机标定（未标定时为空）
+        const cv::Mat& cameraMatrix() const { return camera_matrix_; }
+        const cv::Mat& distCoeffs() const { return dist_coeffs_; }
+
+    private:
+        void unmap();
+
+        ModelBundle(const ModelBundle&);
+        ModelBundle& operator=(const ModelBundle&);
+
+    private:
+        const unsigned char* data_;
+        size_t size_;
+        void* handle_;
+        BundleParams params_;
+        std::vector<cv::Mat> templates_;
+        std::vector<int> labels_;
+        cv::Mat camera_matrix_;
+        cv::Mat dist_coeffs_;
+    };
+
+} // namespace AutoAim
+
+#endif // MODEL_BUNDLE_HPP
\ No newline at end of file
@@ -0,0 +1,81 @@
+﻿#include "ModelReloader.hpp"
+#include "Logger.hpp"
+#include <chrono>
+#include <sstream>
+#include <sys/stat.h>
+
+namespace AutoAim {
+
+    ModelReloader::ModelReloader(const std::string& path, const Builder& builder, int interval_ms)
+        : path_(path),
+        builder_(builder),
+        interval_ms_(interval_ms),
+        pending_(nullptr),
+        retired_(nullptr),
+        running_(true),
+        reloads_(0) {
+        thread_ = std::thread(&ModelReloader::run, this);
+    }
+
+    ModelReloader::~ModelReloader() {
+        running_ = false;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        delete pending_.exchange(nullptr);
+        delete retired_.exchange(nullptr);
+    }
+
+    std::unique_ptr<DetectorSnapshot> ModelReloader::acquire() {
+        // 快速路径：一次原子读，没有更新时不做交换
+        if (pending_.load(std::memory_order_relaxed) == nullptr) {
+            return std::unique_ptr<DetectorSnapshot>();
+        }
+        return std::unique_ptr<DetectorSnapshot>(pending_.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    void ModelReloader::retire(std::unique_ptr<DetectorSnapshot> snapshot) {
+        // 后台线程每个轮询周期回收一次；两次交换间隔小于周期时才在此处释放更早的一份
+        delete retired_.exchange(snapshot.release(), std::memory_order_acq_rel);
+    }
+
+    bool ModelReloader::fileStamp(std::string& stamp) const {
+        struct stat st;
+        uint32_t hash = 0;
+        if (::stat(path_.c_str(), &st) != 0 || !ModelBundle::readContentHash(path_, hash)) {
+            return false;
+        }
+        std::ostringstream oss;
+        oss << hash << ':' << st.st_size << ':' << st.st_mtime;
+        stamp = oss.str();
+        return true;
+    }
+
+    void ModelReloader::run() {
+        std::string last_stamp;
+        fileStamp(last_stamp);
+
+        while (running_) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms_));
+            delete retired_.exchange(nullptr, std::memory_order_acq_rel);
+
+            std::string stamp;
+            if (!fileStamp(stamp) || stamp == last_stamp) {
+                continue;
+            }
+            last_stamp = stamp;
+
+            std::unique_ptr<DetectorSnapshot> snapshot = builder_();
+            if (!snapshot) {
+                Logger::instance().logText(LogLevel::Warn, "热重载失败，继续使用当前模型: " + path_);
+                continue;
+            }
+
+            // 检测线程尚未取走的上一份直接作废
+            delete pending_.exchange(snapshot.release(), std::memory_order_acq_rel);
+            int count = reloads_.fetch_add(1, std::memory_order_relaxed) + 1;
+            Logger::instance().log(LogLevel::Info, "模型已重新加载，第 {} 次", count);
+        }
+    }
+
+} // namespace AutoAim
\ No newline at end of file
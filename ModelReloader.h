@@ -0,0 +1,64 @@
+﻿#ifndef MODEL_RELOADER_HPP
+#define MODEL_RELOADER_HPP
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include "ArmorDetector.hpp"
+#include "NumberRecognizer.hpp"
+#include "ModelBundle.hpp"
+
+namespace AutoAim {
+
+    // 一份完整的检测配置：bundle 与由它配置好的检测器一起发布，互不撕裂
+    struct DetectorSnapshot {
+        std::unique_ptr<ModelBundle> bundle;    // 模板引用其映射内存，须与识别器同生命周期
+        ArmorDetector armor_detector;
+        NumberRecognizer number_recognizer;
+
+        DetectorSnapshot() : bundle(new ModelBundle()), number_recognizer(false) {}
+    };
+
+    // 模型热重载：后台线程监视bundle文件，变化后在热路径外构建新快照，
+    // 通过原子指针交换发布（RCU）。检测线程在帧间无锁取走新快照，
+    // 旧快照交还后台线程释放，检测循环不阻塞、不会读到半更新的参数
+    class ModelReloader {
+    public:
+        typedef std::function<std::unique_ptr<DetectorSnapshot>()> Builder;
+
+        // builder 在后台线程调用，返回空表示本次构建失败（保留旧快照）
+        ModelReloader(const std::string& path, const Builder& builder, int interval_ms = 500);
+        ~ModelReloader();
+
+        // 检测线程调用：有新快照时取走，否则返回空
+        std::unique_ptr<DetectorSnapshot> acquire();
+
+        // 检测线程调用：交还被替换下的快照，由后台线程释放
+        void retire(std::unique_ptr<DetectorSnapshot> snapshot);
+
+        // 已发布的快照数
+        int reloads() const { return reloads_.load(std::memory_order_relaxed); }
+
+    private:
+        void run();
+
+        // 文件标识：内容哈希、大小、修改时间
+        // 修改时间精度可能只有1秒，Windows 上也没有 inode，同一秒内的重写靠内容哈希区分
+        bool fileStamp(std::string& stamp) const;
+
+    private:
+        std::string path_;
+        Builder builder_;
+        int interval_ms_;
+        std::atomic<DetectorSnapshot*> pending_;    // 已构建、尚未被检测线程取走
+        std::atomic<DetectorSnapshot*> retired_;    // 检测线程交还、待释放
+        std::atomic<bool> running_;
+        std::atomic<int> reloads_;
+        std::thread thread_;
+    };
+
+} // namespace AutoAim
+
+#endif // MODEL_RELOADER_HPP
\ No newline at end of file
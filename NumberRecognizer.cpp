@@ -1,16 +1,53 @@
 #include "NumberRecognizer.hpp"
+#include <cmath>
 #include <iostream>
 #include <fstream>
 #include <opencv2/opencv.hpp>
 
 namespace AutoAim {
 
-    NumberRecognizer::NumberRecognizer() {
+    namespace {
+        const int kPatchSize = 32;              // ģߴһ
+        const float kPatchHeightScale = 2.0f;   // ߶ / 
+        const float kPatchInset = 0.15f;        // ˸ȥıܿ
+
+        // ˵㣬top Ϊͼпϵһ
+        void lightBarEnds(const cv::RotatedRect& bar, cv::Point2f& top, cv::Point2f& bottom) {
+            float theta = bar.angle * static_cast<float>(CV_PI) / 180.0f;
+            cv::Point2f axis;
+            float length;
+            if (bar.size.height >= bar.size.width) {
+                axis = cv::Point2f(-std::sin(theta), std::cos(theta));
+                length = bar.size.height;
+            }
+            else {
+                axis = cv::Point2f(std::cos(theta), std::sin(theta));
+                length = bar.size.width;
+            }
+            cv::Point2f half = axis * (length * 0.5f);
+            top = bar.center - half;
+            bottom = bar.center + half;
+            if (top.y > bottom.y) {
+                std::swap(top, bottom);
+            }
+        }
+    }
+
+    NumberRecognizer::NumberRecognizer(bool create_default_templates)
+        : binary_threshold_(100), confidence_threshold_(0.7) {
         // ʼ
         number_names_ = { "1", "2", "3", "4", "7" };
 
         // Ĭģ
-        createDefaultTemplates();
+        if (create_default_templates) {
+            createDefaultTemplates();
+        }
+    }
+
+    void NumberRecognizer::setTemplates(const std::vector<cv::Mat>& templates,
+        const std::vector<int>& labels) {
+        templates_ = templates;
+        template_labels_ = labels;
     }
 
     bool NumberRecognizer::loadTemplates(const std::string& template_dir) {
@@ -59,13 +96,89 @@ namespace AutoAim {
         auto result = templateMatch(processed_roi);
 
         // Ŷֵ
-        if (result.second > 0.7) {  // Ŷֵ
+        if (result.second > confidence_threshold_) {  // Ŷֵ
             return result.first;
         }
 
         return -1;
     }
 
+    cv::Mat NumberRecognizer::extractNumberPatch(const cv::Mat& frame, PixelFormat format,
+        const cv::RotatedRect& left, const cv::RotatedRect& right) {
+        cv::Point2f lt, lb, rt, rb;
+        lightBarEnds(left, lt, lb);
+        lightBarEnds(right, rt, rb);
+
+        // ϰֽĸ߶
+        float grow = (kPatchHeightScale - 1.0f) * 0.5f;
+        cv::Point2f l_dir = lb - lt, r_dir = rb - rt;
+        cv::Point2f l_top = lt - l_dir * grow, l_bottom = lb + l_dir * grow;
+        cv::Point2f r_top = rt - r_dir * grow, r_bottom = rb + r_dir * grow;
+
+        // ҷȥ
+        cv::Point2f src[4] = {
+            l_top + (r_top - l_top) * kPatchInset,
+            r_top + (l_top - r_top) * kPatchInset,
+            r_bottom + (l_bottom - r_bottom) * kPatchInset,
+            l_bottom + (r_bottom - l_bottom) * kPatchInset,
+        };
+        float width = static_cast<float>(cv::norm(src[1] - src[0]));
+        float height = static_cast<float>(cv::norm(src[3] - src[0]));
+        if (width < 2.0f || height < 2.0f) {
+            return cv::Mat();
+        }
+
+        const float n = static_cast<float>(kPatchSize);
+        cv::Point2f dst[4] = {
+            cv::Point2f(0.0f, 0.0f), cv::Point2f(n, 0.0f),
+            cv::Point2f(n, n), cv::Point2f(0.0f, n),
+        };
+        cv::Mat transform = cv::getPerspectiveTransform(src, dst);
+        cv::Size patch_size(kPatchSize, kPatchSize);
+
+        // ֻ32x32أֱӴԭͼԽ粿0
+        cv::Mat patch;
+        if (format == PixelFormat::BGR) {
+            cv::Mat color;
+            cv::warpPerspective(frame, color, transform, patch_size);
+            cv::cvtColor(color, patch, cv::COLOR_BGR2GRAY);
+        }
+        else if (format == PixelFormat::YUYV) {
+            // ˫ͨʱÿصĵ0ͨYֵֻȡͨ
+            cv::Mat yuyv;
+            cv::warpPerspective(frame, yuyv, transform, patch_size);
+            cv::extractChannel(yuyv, patch, 0);
+        }
+        else {
+            // NV12 ǰ height мYƽ
+            cv::Size size = Utils::frameSize(frame, format);
+            cv::warpPerspective(frame.rowRange(0, size.height), patch, transform, patch_size);
+        }
+        return patch;
+    }
+
+    int NumberRecognizer::recognizePatch(const cv::Mat& patch, double* score) {
+        if (score != nullptr) {
+            *score = 0.0;
+        }
+        if (patch.empty()) {
+            return -1;
+        }
+
+        // Уģߴ磬ֵֻ
+        cv::Mat binary;
+        cv::threshold(patch, binary, binary_threshold_, 255, cv::THRESH_BINARY);
+
+        auto result = templateMatch(binary);
+        if (score != nullptr) {
+            *score = result.second;
+        }
+        if (result.second > confidence_threshold_) {
+            return result.first;
+        }
+        return -1;
+    }
+
     cv::Mat NumberRecognizer::preprocessNumberROI(const cv::Mat& roi) {
         cv::Mat gray, binary, resized;
 
@@ -78,7 +191,7 @@ namespace AutoAim {
         }
 
         // ֵ
-        cv::threshold(gray, binary, 100, 255, cv::THRESH_BINARY);
+        cv::threshold(gray, binary, binary_threshold_, 255, cv::THRESH_BINARY);
 
         // ȥС
         cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(2, 2));
@@ -1,94 +1,67 @@
-#ifndef UTILS_HPP
-#define UTILS_HPP
+#ifndef NUMBER_RECOGNIZER_HPP
+#define NUMBER_RECOGNIZER_HPP
 
 #include <opencv2/opencv.hpp>
 #include <string>
 #include <vector>
+#include "Utils.hpp"
 
 namespace AutoAim {
 
-    // ṹ
-    struct Config {
-        std::string input_path;      // Ƶ·
-        std::string output_path;     // Ƶ·
-        std::string enemy_color;     // зɫ: "red"  "blue"
-        int camera_id;               // ͷID
-        bool show_result;            // Ƿʾ
-        bool save_result;            // Ƿ񱣴
-
-        // 캯Ĭֵ
-        Config() :
-            input_path(""),
-            output_path("output.mp4"),
-            enemy_color("red"),
-            camera_id(0),
-            show_result(true),
-            save_result(false) {
-        }
-    };
-
-    // װװṹ
-    struct Armor {
-        cv::RotatedRect left_light;   // 
-        cv::RotatedRect right_light;  // ҵ
-        cv::Rect bounding_rect;       // װװ
-        int number;                   // ʶ𵽵
-        double confidence;            // Ŷ
-        bool is_large;                // ǷΪװװ
-
-        // 캯
-        Armor() : number(-1), confidence(0.0), is_large(false) {}
-    };
-
-    // ߺ
-    class Utils {
+    class NumberRecognizer {
     public:
-        // в
-        static Config parseArguments(int argc, char** argv);
+        // create_default_templates ΪfalseʱĬģ壨ģʱʹã
+        explicit NumberRecognizer(bool create_default_templates = true);
 
-        // ɫתBGRתHSV
-        static cv::Mat bgr2hsv(const cv::Mat& bgr_frame);
+        // ģ
+        bool loadTemplates(const std::string& template_dir);
 
-        // ɫָɫֵȡ
-        static cv::Mat colorSegmentation(const cv::Mat& frame, const std::string& color);
+        // Ԥģ壨bundleӳڴ棩
+        void setTemplates(const std::vector<cv::Mat>& templates, const std::vector<int>& labels);
 
-        // װװ
-        static void drawArmor(cv::Mat& frame, const Armor& armor);
+        // ǰģ
+        const std::vector<cv::Mat>& templates() const { return templates_; }
+        const std::vector<int>& templateLabels() const { return template_labels_; }
 
-        // Ƶ
-        static void drawLightBar(cv::Mat& frame, const cv::RotatedRect& light);
+        // ʶŶֵ
+        void setConfidenceThreshold(double threshold) { confidence_threshold_ = threshold; }
 
-        // ȡǰʱ
-        static std::string getCurrentTime();
+        // ROIֵֵ
+        void setBinaryThreshold(int threshold) { binary_threshold_ = threshold; }
 
-        // ӡϢ
-        static void debugPrint(const std::string& message);
+        // ʶ
+        int recognize(const cv::Mat& roi);
 
-        // ֵڷΧ
-        template<typename T>
-        static T clamp(T value, T min_val, T max_val) {
-            return (value < min_val) ? min_val : ((value > max_val) ? max_val : value);
-        }
+        // ҵ˵ıΣԭͼһ͸ӲõУ32x32Ҷͼ
+        // мROIͼߴ޹أ˻ʱؿ
+        static cv::Mat extractNumberPatch(const cv::Mat& frame, PixelFormat format,
+            const cv::RotatedRect& left, const cv::RotatedRect& right);
 
-        // ֮ľ
-        static double distance(const cv::Point2f& p1, const cv::Point2f& p2);
+        // ʶ extractNumberPatch õ32x32Ҷͼ
+        // score ǿʱдģƥ÷֣ŶȣδֵͨʱҲд룩
+        int recognizePatch(const cv::Mat& patch, double* score = nullptr);
 
-        // ȡתεĸ
-        static std::vector<cv::Point2f> getRotatedRectVertices(const cv::RotatedRect& rect);
+        // ȡ
+        std::string getNumberName(int number);
 
-        // ȫػȡROI
-        static cv::Mat getSafeROI(const cv::Mat& frame, const cv::Rect& roi);
+    private:
+        // ԤROI
+        cv::Mat preprocessNumberROI(const cv::Mat& roi);
 
-        // ʾͼ񣨵ã
-        static void showImage(const std::string& window_name, const cv::Mat& image, int delay_ms = 1);
+        // ģƥ䣬(, ÷)
+        std::pair<int, double> templateMatch(const cv::Mat& processed_roi);
 
-        // ͼ񣨵ã
-        static void saveImage(const std::string& filename, const cv::Mat& image);
+        // Ĭģ
+        void createDefaultTemplates();
 
-        // ļǷ
-        static bool fileExists(const std::string& filename);
+    private:
+        std::vector<cv::Mat> templates_;        // ģ
+        std::vector<int> template_labels_;      // ģӦ
+        std::vector<std::string> number_names_; // 
+        int binary_threshold_;                  // ROIֵֵ
+        double confidence_threshold_;           // ʶŶֵ
     };
 
 } // namespace AutoAim
 
-#endif // UTILS_HPP
\ No newline at end of file
+#endif // NUMBER_RECOGNIZER_HPP
\ No newline at end of file
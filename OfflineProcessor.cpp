@@ -0,0 +1,296 @@
+﻿#include "OfflineProcessor.hpp"
+#include "ArmorDetector.hpp"
+#include "NumberRecognizer.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace AutoAim {
+
+    OfflineProcessor::OfflineProcessor(const Config& config) : config_(config) {
+        if (config_.input_path.empty()) {
+            throw std::runtime_error("离线模式需要指定输入视频文件!");
+        }
+
+        if (!config_.color_lut_path.empty()) {
+            std::shared_ptr<ColorLut> lut = std::make_shared<ColorLut>();
+            if (!lut->load(config_.color_lut_path)) {
+                throw std::runtime_error("无法加载颜色查找表!");
+            }
+            color_lut_ = lut;
+        }
+
+        if (!config_.bundle_path.empty()) {
+            bundle_.reset(new ModelBundle());
+            if (!bundle_->load(config_.bundle_path)) {
+                throw std::runtime_error("无法加载bundle文件!");
+            }
+        }
+    }
+
+    void OfflineProcessor::process() {
+        cv::VideoCapture cap(config_.input_path);
+        if (!cap.isOpened()) {
+            throw std::runtime_error("无法打开视频源!");
+        }
+
+        int total_frames = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_COUNT));
+        double fps = cap.get(cv::CAP_PROP_FPS);
+        cv::Size frame_size(
+            static_cast<int>(cap.get(cv::CAP_PROP_FRAME_WIDTH)),
+            static_cast<int>(cap.get(cv::CAP_PROP_FRAME_HEIGHT)));
+        cap.release();
+
+        int workers = config_.workers > 0 ? config_.workers
+            : static_cast<int>(std::thread::hardware_concurrency());
+        workers = std::max(1, workers);
+
+        // 并行由分块承担，关闭OpenCV内部多线程避免超额订阅
+        int cv_threads = cv::getNumThreads();
+        cv::setNumThreads(1);
+
+        std::vector<Chunk> chunks = splitChunks(total_frames, workers);
+        std::cout << "离线模式: " << total_frames << " 帧, " << chunks.size()
+            << " 块, " << workers << " 线程" << std::endl;
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        // 工作线程动态领取分块
+        std::atomic<size_t> next_chunk(0);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < workers; ++i) {
+            threads.emplace_back([&]() {
+                size_t index;
+                while ((index = next_chunk.fetch_add(1)) < chunks.size()) {
+                    processChunk(chunks[index], fps, frame_size);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        auto end_time = std::chrono::high_resolution_clock::now();
+        double total_elapsed = std::chrono::duration<double>(end_time - start_time).count();
+
+        cv::setNumThreads(cv_threads);
+
+        int frame_num = 0;
+        for (const auto& chunk : chunks) {
+            if (!chunk.ok) {
+                std::cerr << "警告: 分块 [" << chunk.start << ", " << chunk.end << ") 处理失败" << std::endl;
+            }
+            frame_num += static_cast<int>(chunk.armors.size());
+        }
+
+        writeResults(chunks);
+        if (config_.save_result) {
+            mergeVideo(chunks, fps, frame_size);
+        }
+
+        std::cout << "处理完成!" << std::endl;
+        std::cout << "总帧数: " << frame_num << std::endl;
+        std::cout << "总时间: " << total_elapsed << " 秒" << std::endl;
+        std::cout << "平均帧率: " << frame_num / total_elapsed << " FPS" << std::endl;
+    }
+
+    std::vector<OfflineProcessor::Chunk> OfflineProcessor::splitChunks(int total_frames, int workers) {
+        std::vector<Chunk> chunks;
+
+        // 分块数约为线程数的4倍以均衡负载，块长取GOP的整数倍，
+        // 使每块起点落在关键帧上，定位时不必从上一个关键帧解码
+        int gop = std::max(1, config_.gop_size);
+        int target = total_frames > 0 ? (total_frames + workers * 4 - 1) / (workers * 4) : gop;
+        int chunk_frames = std::max(1, (target + gop - 1) / gop) * gop;
+
+        int start = 0;
+        do {
+            Chunk chunk;
+            chunk.start = start;
+            chunk.end = start + chunk_frames;
+            chunk.ok = false;
+            chunks.push_back(chunk);
+            start += chunk_frames;
+        } while (start < total_frames);
+
+        // 帧数统计可能不准，最后一块读到文件结尾
+        chunks.back().end = -1;
+
+        if (config_.save_result) {
+            for (size_t i = 0; i < chunks.size(); ++i) {
+                chunks[i].part_path = config_.output_path + ".part" + std::to_string(i) + ".avi";
+            }
+        }
+
+        return chunks;
+    }
+
+    void OfflineProcessor::processChunk(Chunk& chunk, double fps, const cv::Size& frame_size) {
+        cv::VideoCapture cap(config_.input_path);
+        if (!cap.isOpened()) {
+            return;
+        }
+
+        // 每块独立的检测器与识别器
+        ArmorDetector armor_detector;
+        LightBarDetector light_detector(config_.enemy_color);
+        light_detector.setSparseMask(config_.sparse_mask);
+        light_detector.setBrightnessFirst(config_.brightness_first);
+        light_detector.setColorLut(color_lut_);
+        NumberRecognizer number_recognizer(!bundle_);
+        if (bundle_) {
+            // 模板引用共享的映射内存，匹配时只读
+            bundle_->apply(light_detector, armor_detector, number_recognizer);
+        }
+        else {
+            number_recognizer.loadTemplates("data/templates");
+        }
+        armor_detector.setLightBarDetector(light_detector);
+
+        cv::VideoWriter writer;
+        if (!chunk.part_path.empty()) {
+            writer.open(chunk.part_path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), fps, frame_size);
+        }
+
+        if (!seekTo(cap, chunk.start)) {
+            std::cerr << "警告: 无法定位到第 " << chunk.start << " 帧" << std::endl;
+            return;
+        }
+
+        cv::Mat frame;
+        int index = chunk.start;
+        for (; chunk.end < 0 || index < chunk.end; ++index) {
+            if (!cap.read(frame) || frame.empty()) {
+                break;
+            }
+
+            std::vector<Armor> armors;
+            try {
+                armors = armor_detector.detect(frame);
+                for (auto& armor : armors) {
+                    cv::Mat patch = NumberRecognizer::extractNumberPatch(frame, PixelFormat::BGR,
+                        armor.left_light, armor.right_light);
+                    armor.number = number_recognizer.recognizePatch(patch, &armor.confidence);
+                }
+            }
+            catch (const std::exception& e) {
+                std::cerr << "处理帧 " << index << " 时出错: " << e.what() << std::endl;
+            }
+
+            if (writer.isOpened()) {
+                for (const auto& armor : armors) {
+                    Utils::drawArmor(frame, armor);
+                }
+                writer.write(frame);
+            }
+
+            chunk.armors.push_back(armors);
+        }
+
+        // 非末块提前读完说明文件截断或解码出错，后续帧序号不可信
+        chunk.ok = chunk.end < 0 || index == chunk.end;
+    }
+
+    bool OfflineProcessor::seekTo(cv::VideoCapture& cap, int frame) {
+        if (frame <= 0) {
+            return true;
+        }
+
+        // 后端定位不精确：落在目标之前时逐帧跳过，越过目标时从头重新读取
+        cap.set(cv::CAP_PROP_POS_FRAMES, frame);
+        int pos = static_cast<int>(cap.get(cv::CAP_PROP_POS_FRAMES));
+        if (pos < 0 || pos > frame) {
+            std::cerr << "警告: 定位到第 " << frame << " 帧时落在第 " << pos << " 帧，从头读取" << std::endl;
+            cap.release();
+            if (!cap.open(config_.input_path)) {
+                return false;
+            }
+            pos = 0;
+        }
+
+        while (pos < frame) {
+            if (!cap.grab()) {
+                return false;
+            }
+            pos++;
+        }
+        return true;
+    }
+
+    void OfflineProcessor::writeResults(const std::vector<Chunk>& chunks) {
+        if (config_.results_path.empty()) {
+            return;
+        }
+
+        std::ofstream out(config_.results_path);
+        if (!out) {
+            std::cerr << "警告: 无法创建结果文件 " << config_.results_path << std::endl;
+            return;
+        }
+
+        out << "frame,number,is_large,x,y,width,height,"
+            "left_x,left_y,left_h,left_angle,right_x,right_y,right_h,right_angle,color\n";
+
+        for (const auto& chunk : chunks) {
+            for (size_t i = 0; i < chunk.armors.size(); ++i) {
+                int frame_index = chunk.start + static_cast<int>(i);
+                for (const auto& armor : chunk.armors[i]) {
+                    out << frame_index << ',' << armor.number << ',' << (armor.is_large ? 1 : 0) << ','
+                        << armor.bounding_rect.x << ',' << armor.bounding_rect.y << ','
+                        << armor.bounding_rect.width << ',' << armor.bounding_rect.height << ','
+                        << armor.left_light.center.x << ',' << armor.left_light.center.y << ','
+                        << armor.left_light.size.height << ',' << armor.left_light.angle << ','
+                        << armor.right_light.center.x << ',' << armor.right_light.center.y << ','
+                        << armor.right_light.size.height << ',' << armor.right_light.angle << ','
+                        << static_cast<int>(armor.color) << '\n';
+                }
+            }
+        }
+
+        std::cout << "检测结果已保存: " << config_.results_path << std::endl;
+    }
+
+    void OfflineProcessor::mergeVideo(const std::vector<Chunk>& chunks, double fps,
+        const cv::Size& frame_size) {
+        cv::VideoWriter writer(config_.output_path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'),
+            fps, frame_size);
+        if (!writer.isOpened()) {
+            std::cerr << "警告: 无法创建输出视频文件" << std::endl;
+            return;
+        }
+
+        // 任一分块失败时保留分块文件，便于排查
+        bool complete = true;
+        cv::Mat frame;
+        for (const auto& chunk : chunks) {
+            cv::VideoCapture part(chunk.part_path);
+            if (!chunk.ok || !part.isOpened()) {
+                std::cerr << "警告: 分块视频 " << chunk.part_path << " 不完整" << std::endl;
+                complete = false;
+                continue;
+            }
+            int frames = 0;
+            while (part.read(frame) && !frame.empty()) {
+                writer.write(frame);
+                frames++;
+            }
+            if (frames != static_cast<int>(chunk.armors.size())) {
+                std::cerr << "警告: 分块视频 " << chunk.part_path << " 帧数不符" << std::endl;
+                complete = false;
+            }
+        }
+        writer.release();
+
+        if (!complete) {
+            std::cerr << "警告: 输出视频不完整，保留分块文件" << std::endl;
+            return;
+        }
+        for (const auto& chunk : chunks) {
+            std::remove(chunk.part_path.c_str());
+        }
+    }
+
+} // namespace AutoAim
\ No newline at end of file
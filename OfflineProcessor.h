@@ -0,0 +1,55 @@
+﻿#ifndef OFFLINE_PROCESSOR_HPP
+#define OFFLINE_PROCESSOR_HPP
+
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Utils.hpp"
+#include "ColorLut.hpp"
+#include "ModelBundle.hpp"
+
+namespace AutoAim {
+
+    // 离线分块并行处理：按GOP对齐切分录像，每块独立解码和检测，结果按帧序合并
+    class OfflineProcessor {
+    public:
+        explicit OfflineProcessor(const Config& config);
+
+        // 处理整个视频文件
+        void process();
+
+    private:
+        // 帧区间 [start, end)，最后一块 end 为 -1 表示读到文件结尾
+        struct Chunk {
+            int start;
+            int end;
+            std::vector<std::vector<Armor>> armors;     // 每帧检测结果
+            std::string part_path;                      // 分块结果视频
+            bool ok;                                    // 定位成功且读满整块
+        };
+
+        // 切分视频
+        std::vector<Chunk> splitChunks(int total_frames, int workers);
+
+        // 工作线程：处理一个分块
+        void processChunk(Chunk& chunk, double fps, const cv::Size& frame_size);
+
+        // 定位到第 frame 帧；后端定位越过目标时从头逐帧读取
+        bool seekTo(cv::VideoCapture& cap, int frame);
+
+        // 按帧序写出检测结果
+        void writeResults(const std::vector<Chunk>& chunks);
+
+        // 按顺序拼接分块视频
+        void mergeVideo(const std::vector<Chunk>& chunks, double fps, const cv::Size& frame_size);
+
+    private:
+        Config config_;
+        std::shared_ptr<const ColorLut> color_lut_;    // 各线程共享（只读）
+        std::unique_ptr<ModelBundle> bundle_;          // 各线程共享（只读），未指定时为空
+    };
+
+} // namespace AutoAim
+
+#endif // OFFLINE_PROCESSOR_HPP
\ No newline at end of file
@@ -0,0 +1,201 @@
+﻿#include "OverlayRenderer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace AutoAim {
+
+    namespace {
+        double nowSeconds() {
+            return std::chrono::duration<double>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // YUV帧按最近邻在原格式下缩小（YUYV宏像素、NV12色度对整体取样），
+        // 之后的颜色转换只处理预览尺寸的像素
+        cv::Mat shrinkYUV(const cv::Mat& frame, PixelFormat format, double scale) {
+            const cv::Size size = Utils::frameSize(frame, format);
+            const int width = std::max(2, static_cast<int>(size.width * scale) & ~1);
+            const int height = std::max(2, static_cast<int>(size.height * scale) & ~1);
+            auto source = [scale](int i, int limit) {
+                return std::min(limit - 1, static_cast<int>(i / scale));
+            };
+
+            if (format == PixelFormat::YUYV) {
+                cv::Mat small(height, width, CV_8UC2);
+                for (int r = 0; r < height; ++r) {
+                    const uchar* src = frame.ptr<uchar>(source(r, size.height));
+                    uchar* dst = small.ptr<uchar>(r);
+                    for (int j = 0; j < width / 2; ++j) {
+                        std::memcpy(dst + j * 4, src + source(j, size.width / 2) * 4, 4);
+                    }
+                }
+                return small;
+            }
+
+            // NV12：亮度平面之后是半高的交错UV平面
+            cv::Mat small(height * 3 / 2, width, CV_8UC1);
+            for (int r = 0; r < height; ++r) {
+                const uchar* src = frame.ptr<uchar>(source(r, size.height));
+                uchar* dst = small.ptr<uchar>(r);
+                for (int c = 0; c < width; ++c) {
+                    dst[c] = src[source(c, size.width)];
+                }
+            }
+            for (int r = 0; r < height / 2; ++r) {
+                const uchar* src = frame.ptr<uchar>(size.height + source(r, size.height / 2));
+                uchar* dst = small.ptr<uchar>(height + r);
+                for (int j = 0; j < width / 2; ++j) {
+                    std::memcpy(dst + j * 2, src + source(j, size.width / 2) * 2, 2);
+                }
+            }
+            return small;
+        }
+    }
+
+    OverlayRenderer::OverlayRenderer(const std::string& window_name, const std::string& enemy_color,
+        double max_fps, double scale)
+        : window_name_(window_name),
+        enemy_color_(enemy_color),
+        scale_(scale > 0.0 && scale <= 1.0 ? scale : 1.0),
+        min_interval_(max_fps > 0.0 ? 1.0 / max_fps : 0.0),
+        last_submit_(0.0),
+        running_(false),
+        has_pending_(false),
+        stop_requested_(false),
+        dump_requested_(false) {
+    }
+
+    OverlayRenderer::~OverlayRenderer() {
+        stop();
+    }
+
+    void OverlayRenderer::start() {
+        if (thread_.joinable()) {
+            return;
+        }
+        running_ = true;
+        thread_ = std::thread(&OverlayRenderer::run, this);
+    }
+
+    void OverlayRenderer::stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cond_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    bool OverlayRenderer::submit(const cv::Mat& frame, PixelFormat format,
+        const std::vector<Armor>& armors, const FrameStats& stats) {
+        // 限制显示帧率，超出部分不做任何拷贝
+        double now = nowSeconds();
+        if (now - last_submit_ < min_interval_) {
+            return false;
+        }
+        last_submit_ = now;
+
+        // 在检测线程上缩小一次；调用返回后帧缓冲区可被采集覆盖
+        // YUV先在原格式下缩小再转换，不做整帧颜色转换
+        cv::Mat preview;
+        if (format != PixelFormat::BGR) {
+            preview = Utils::toBGR(scale_ < 1.0 ? shrinkYUV(frame, format, scale_) : frame, format);
+        }
+        else if (scale_ < 1.0) {
+            cv::resize(frame, preview, cv::Size(), scale_, scale_, cv::INTER_NEAREST);
+        }
+        else {
+            preview = frame.clone();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_preview_ = preview;
+            pending_armors_ = armors;
+            pending_stats_ = stats;
+            has_pending_ = true;
+        }
+        cond_.notify_one();
+        return true;
+    }
+
+    void OverlayRenderer::run() {
+        cv::Mat preview;
+        std::vector<Armor> armors;
+        FrameStats stats;
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_.wait_for(lock, std::chrono::milliseconds(30),
+                    [this] { return has_pending_ || !running_; });
+                if (!running_) {
+                    break;
+                }
+                if (has_pending_) {
+                    // 只保留最新一帧
+                    cv::swap(preview, pending_preview_);
+                    armors.swap(pending_armors_);
+                    stats = pending_stats_;
+                    has_pending_ = false;
+                }
+                else {
+                    preview.release();
+                }
+            }
+
+            if (!preview.empty()) {
+                drawOverlay(preview, armors, stats);
+                cv::imshow(window_name_, preview);
+            }
+
+            // 无新帧时也要处理窗口事件
+            int key = cv::waitKey(1);
+            if (key == 27) {  // ESC键退出
+                stop_requested_ = true;
+            }
+            else if (key == 'd' || key == 'D') {
+                dump_requested_ = true;
+            }
+        }
+    }
+
+    void OverlayRenderer::drawOverlay(cv::Mat& preview, const std::vector<Armor>& armors,
+        const FrameStats& stats) {
+        for (const auto& armor : armors) {
+            Utils::drawArmor(preview, scaleArmor(armor));
+        }
+
+        if (armors.empty()) {
+            cv::putText(preview, "No armor detected",
+                cv::Point(50, 50), cv::FONT_HERSHEY_SIMPLEX,
+                1.0, cv::Scalar(0, 0, 255), 2);
+        }
+
+        Utils::drawStats(preview, stats.frame_count, stats.fps, enemy_color_);
+
+        // 时间戳只在显示时格式化
+        std::string time_text = "Time: " + Utils::getCurrentTime();
+        cv::putText(preview, time_text, cv::Point(10, 120),
+            cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(200, 200, 200), 1);
+    }
+
+    Armor OverlayRenderer::scaleArmor(const Armor& armor) const {
+        Armor scaled = armor;
+        float s = static_cast<float>(scale_);
+
+        scaled.left_light.center = armor.left_light.center * s;
+        scaled.left_light.size = cv::Size2f(armor.left_light.size.width * s, armor.left_light.size.height * s);
+        scaled.right_light.center = armor.right_light.center * s;
+        scaled.right_light.size = cv::Size2f(armor.right_light.size.width * s, armor.right_light.size.height * s);
+        scaled.bounding_rect = cv::Rect(
+            cvRound(armor.bounding_rect.x * scale_), cvRound(armor.bounding_rect.y * scale_),
+            cvRound(armor.bounding_rect.width * scale_), cvRound(armor.bounding_rect.height * scale_));
+
+        return scaled;
+    }
+
+} // namespace AutoAim
\ No newline at end of file
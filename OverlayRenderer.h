@@ -0,0 +1,75 @@
+﻿#ifndef OVERLAY_RENDERER_HPP
+#define OVERLAY_RENDERER_HPP
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Utils.hpp"
+
+namespace AutoAim {
+
+    // 单帧统计信息
+    struct FrameStats {
+        int frame_count;    // 帧号
+        double fps;         // 处理帧率，<=0 不显示
+
+        FrameStats() : frame_count(0), fps(0.0) {}
+    };
+
+    // 预览渲染器：独立线程按限定帧率绘制缩小的预览图，检测循环不等待显示
+    class OverlayRenderer {
+    public:
+        OverlayRenderer(const std::string& window_name, const std::string& enemy_color,
+            double max_fps = 30.0, double scale = 0.5);
+        ~OverlayRenderer();
+
+        // 启动/停止渲染线程
+        void start();
+        void stop();
+
+        // 提交一帧检测结果；未到显示间隔时直接丢弃，返回是否被接收
+        bool submit(const cv::Mat& frame, PixelFormat format,
+            const std::vector<Armor>& armors, const FrameStats& stats);
+
+        // 预览窗口中按下ESC
+        bool stopRequested() const { return stop_requested_.load(); }
+
+        // 预览窗口中按下D请求转储飞行记录，读取后清除
+        bool takeDumpRequest() { return dump_requested_.exchange(false); }
+
+    private:
+        // 渲染线程主循环
+        void run();
+
+        // 在预览图上绘制检测结果
+        void drawOverlay(cv::Mat& preview, const std::vector<Armor>& armors, const FrameStats& stats);
+
+        // 按预览比例缩放装甲板坐标
+        Armor scaleArmor(const Armor& armor) const;
+
+    private:
+        std::string window_name_;
+        std::string enemy_color_;
+        double scale_;                  // 预览缩放比例
+        double min_interval_;           // 最小显示间隔（秒）
+        double last_submit_;            // 上次接收时间（秒）
+
+        std::thread thread_;
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        bool running_;
+        bool has_pending_;              // 邮箱中是否有新帧
+        cv::Mat pending_preview_;       // 邮箱：缩小后的预览图
+        std::vector<Armor> pending_armors_;
+        FrameStats pending_stats_;
+        std::atomic<bool> stop_requested_;
+        std::atomic<bool> dump_requested_;
+    };
+
+} // namespace AutoAim
+
+#endif // OVERLAY_RENDERER_HPP
\ No newline at end of file
@@ -0,0 +1,251 @@
+﻿// 灯条配对一致性与耗时测试：ArmorDetector 的批量配对与逐对参考实现逐帧对比
+// 用法: pair_bench [--frames N] [--bars N]
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "ArmorDetector.hpp"
+
+using namespace AutoAim;
+
+namespace {
+
+    // 与 ArmorDetector 默认配对阈值相同
+    const float kMaxHeightRatio = 2.0f;
+    const float kMaxAngleDiff = 20.0f;
+    const float kMinDistanceRatio = 0.5f;
+    const float kMaxDistanceRatio = 4.0f;
+
+    struct PairMetrics {
+        float height_ratio;
+        float angle_diff;
+        float distance_ratio;
+        float y_ratio;
+    };
+
+    // 参考实现：逐对计算几何特征，逐条件判断
+    PairMetrics pairMetrics(const cv::RotatedRect& left, const cv::RotatedRect& right) {
+        PairMetrics m;
+        float left_height = left.size.height;
+        float right_height = right.size.height;
+        m.height_ratio = std::max(left_height, right_height) / std::min(left_height, right_height);
+
+        float left_angle = std::abs(left.angle);
+        float right_angle = std::abs(right.angle);
+        if (left_angle > 90) left_angle = 180 - left_angle;
+        if (right_angle > 90) right_angle = 180 - right_angle;
+        m.angle_diff = std::abs(left_angle - right_angle);
+
+        float avg_height = (left_height + right_height) / 2.0f;
+        m.distance_ratio = std::abs(right.center.x - left.center.x) / avg_height;
+        m.y_ratio = std::abs(right.center.y - left.center.y) / avg_height;
+        return m;
+    }
+
+    bool canPair(const PairMetrics& m) {
+        if (m.height_ratio > kMaxHeightRatio) return false;
+        if (m.angle_diff > kMaxAngleDiff) return false;
+        if (m.distance_ratio < kMinDistanceRatio || m.distance_ratio > kMaxDistanceRatio) return false;
+        if (m.y_ratio > 1.0f) return false;
+        return true;
+    }
+
+    float pairScore(const PairMetrics& m) {
+        float height_term = (m.height_ratio - 1.0f) / (kMaxHeightRatio - 1.0f);
+        float angle_term = m.angle_diff / kMaxAngleDiff;
+        float y_term = m.y_ratio;
+        float nominal = m.distance_ratio > 3.5f ? 4.5f : 2.5f;
+        float distance_term = std::abs(m.distance_ratio - nominal) / nominal;
+        return height_term + angle_term + y_term + distance_term;
+    }
+
+    cv::Rect armorRect(const cv::RotatedRect& left, const cv::RotatedRect& right) {
+        float x1 = std::min(left.center.x - left.size.width / 2, right.center.x - right.size.width / 2);
+        float x2 = std::max(left.center.x + left.size.width / 2, right.center.x + right.size.width / 2);
+        float y1 = std::min(left.center.y - left.size.height / 2, right.center.y - right.size.height / 2);
+        float y2 = std::max(left.center.y + left.size.height / 2, right.center.y + right.size.height / 2);
+        float expand = 0.2;
+        float width = x2 - x1;
+        float height = y2 - y1;
+        x1 -= width * expand / 2;
+        x2 += width * expand / 2;
+        y1 -= height * expand / 2;
+        y2 += height * expand / 2;
+        x1 = std::max(0.0f, x1);
+        y1 = std::max(0.0f, y1);
+        return cv::Rect(x1, y1, x2 - x1, y2 - y1);
+    }
+
+    // 参考实现：全部候选稳定排序后贪心分配，面积不合格的候选不占用灯条
+    std::vector<Armor> referencePairing(const std::vector<cv::RotatedRect>& light_bars) {
+        std::vector<Armor> armors;
+        if (light_bars.size() < 2) {
+            return armors;
+        }
+
+        std::vector<cv::RotatedRect> sorted_bars = light_bars;
+        std::sort(sorted_bars.begin(), sorted_bars.end(),
+            [](const cv::RotatedRect& a, const cv::RotatedRect& b) {
+                return a.center.x < b.center.x;
+            });
+
+        struct Candidate {
+            size_t left;
+            size_t right;
+            float score;
+        };
+        std::vector<Candidate> candidates;
+        for (size_t i = 0; i < sorted_bars.size(); ++i) {
+            for (size_t j = i + 1; j < sorted_bars.size(); ++j) {
+                PairMetrics m = pairMetrics(sorted_bars[i], sorted_bars[j]);
+                if (canPair(m)) {
+                    Candidate candidate = { i, j, pairScore(m) };
+                    candidates.push_back(candidate);
+                }
+            }
+        }
+        std::stable_sort(candidates.begin(), candidates.end(),
+            [](const Candidate& a, const Candidate& b) {
+                return a.score < b.score;
+            });
+
+        std::vector<bool> used(sorted_bars.size(), false);
+        for (const auto& candidate : candidates) {
+            if (used[candidate.left] || used[candidate.right]) {
+                continue;
+            }
+            cv::Rect rect = armorRect(sorted_bars[candidate.left], sorted_bars[candidate.right]);
+            if (rect.area() < 100 || rect.area() > 10000) {
+                continue;
+            }
+            used[candidate.left] = true;
+            used[candidate.right] = true;
+
+            Armor armor;
+            armor.left_light = sorted_bars[candidate.left];
+            armor.right_light = sorted_bars[candidate.right];
+            armor.bounding_rect = rect;
+            float distance = std::abs(armor.right_light.center.x - armor.left_light.center.x);
+            float avg_height = (armor.left_light.size.height + armor.right_light.size.height) / 2.0;
+            armor.is_large = distance / avg_height > 3.5;
+            armors.push_back(armor);
+        }
+        return armors;
+    }
+
+    bool sameLight(const cv::RotatedRect& a, const cv::RotatedRect& b) {
+        return a.center == b.center && a.size == b.size && a.angle == b.angle;
+    }
+
+    bool sameArmors(const std::vector<Armor>& a, const std::vector<Armor>& b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (!sameLight(a[i].left_light, b[i].left_light) || !sameLight(a[i].right_light, b[i].right_light) ||
+                a[i].bounding_rect != b[i].bounding_rect || a[i].is_large != b[i].is_large) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 一帧灯条：成对放置的装甲板灯条（小/大装甲间距）加随机干扰灯条
+    std::vector<cv::RotatedRect> randomFrame(std::mt19937& rng, int bars) {
+        std::uniform_real_distribution<float> x_dist(0.0f, 1280.0f), y_dist(0.0f, 1024.0f);
+        std::uniform_real_distribution<float> height_dist(8.0f, 60.0f), unit(0.0f, 1.0f);
+        std::normal_distribution<float> noise(0.0f, 1.0f);
+
+        // 角度覆盖 minAreaRect 的不同约定（接近0或接近180）
+        auto angle = [&]() {
+            float a = noise(rng) * 8.0f;
+            return unit(rng) < 0.3f ? 180.0f - std::abs(a) : a;
+        };
+
+        std::vector<cv::RotatedRect> frame;
+        while (static_cast<int>(frame.size()) < bars) {
+            float h = height_dist(rng);
+            cv::Point2f center(x_dist(rng), y_dist(rng));
+            frame.push_back(cv::RotatedRect(center, cv::Size2f(h / 4.0f, h), angle()));
+            if (unit(rng) < 0.6f) {
+                float ratio = (unit(rng) < 0.5f ? 2.5f : 4.5f) + noise(rng) * 0.4f;
+                float h2 = h * (1.0f + noise(rng) * 0.15f);
+                cv::Point2f other(center.x + ratio * h, center.y + noise(rng) * h * 0.3f);
+                frame.push_back(cv::RotatedRect(other, cv::Size2f(h2 / 4.0f, h2), angle()));
+            }
+        }
+        return frame;
+    }
+
+    double elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+}
+
+int main(int argc, char** argv) {
+    int frames = 2000;
+    int bars = 24;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        }
+        else if (arg == "--bars" && i + 1 < argc) {
+            bars = std::atoi(argv[++i]);
+        }
+        else {
+            std::printf("用法: pair_bench [--frames N] [--bars N]\n");
+            return 1;
+        }
+    }
+
+    std::mt19937 rng(42);
+    std::vector<std::vector<cv::RotatedRect>> inputs;
+    for (int f = 0; f < frames; ++f) {
+        inputs.push_back(randomFrame(rng, bars));
+    }
+
+    // 逐帧对比
+    ArmorDetector detector;
+    int mismatched = 0;
+    size_t armors = 0;
+    for (int f = 0; f < frames; ++f) {
+        std::vector<Armor> expected = referencePairing(inputs[f]);
+        std::vector<Armor> actual = detector.pairLightBars(inputs[f]);
+        armors += actual.size();
+        if (!sameArmors(expected, actual)) {
+            if (mismatched < 5) {
+                std::printf("第 %d 帧不一致: 参考 %zu 个，批量 %zu 个\n", f, expected.size(), actual.size());
+            }
+            ++mismatched;
+        }
+    }
+    std::printf("对比 %d 帧（每帧约 %d 个灯条，共 %zu 个装甲板）: %d 帧不一致\n", frames, bars, armors, mismatched);
+
+    // 耗时
+    auto start = std::chrono::steady_clock::now();
+    size_t sink = 0;
+    for (const auto& input : inputs) {
+        sink += referencePairing(input).size();
+    }
+    double reference_ms = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    for (const auto& input : inputs) {
+        sink += detector.pairLightBars(input).size();
+    }
+    double batch_ms = elapsedMs(start);
+
+    std::printf("逐对参考: %.2f us/帧  批量: %.2f us/帧  (%zu)\n",
+        reference_ms * 1000.0 / frames, batch_ms * 1000.0 / frames, sink);
+
+    return mismatched == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+﻿#ifndef PIXEL_FORMAT_HPP
+#define PIXEL_FORMAT_HPP
+
+// 不依赖OpenCV，供对外接口（DetectionEngine）使用
+
+namespace AutoAim {
+
+    // 输入像素格式
+    enum class PixelFormat {
+        BGR,    // 8UC3 BGR
+        YUYV,   // 8UC2 打包YUV 4:2:2（Y0 U Y1 V）
+        NV12    // 8UC1 Y平面 + 交错UV平面，共 rows*3/2 行
+    };
+
+} // namespace AutoAim
+
+#endif // PIXEL_FORMAT_HPP
\ No newline at end of file
@@ -0,0 +1,206 @@
+﻿#include "PooledAllocator.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace AutoAim {
+
+    namespace {
+        const size_t kAlignment = 64;
+        const size_t kPageSize = 4096;
+        const size_t kMinClassSize = 256;               // 最小分级
+        const size_t kHugePageMin = 2 * 1024 * 1024;    // 不小于此尺寸才申请大页
+    }
+
+    PooledAllocator& PooledAllocator::instance() {
+        // 有意不析构：静态析构阶段仍可能有 Mat 释放回本分配器
+        static PooledAllocator* allocator = new PooledAllocator();
+        return *allocator;
+    }
+
+    void PooledAllocator::install(bool huge_pages) {
+        PooledAllocator& allocator = instance();
+        allocator.huge_pages_ = huge_pages;
+        cv::Mat::setDefaultAllocator(&allocator);
+    }
+
+    PooledAllocator::PooledAllocator()
+        : huge_pages_(false),
+        max_cached_(512u * 1024 * 1024),
+        hits_(0),
+        misses_(0),
+        resident_(0),
+        cached_(0) {
+    }
+
+    int PooledAllocator::sizeClass(size_t size) {
+        if (size <= kMinClassSize) {
+            return 0;
+        }
+        // 最高位所在的2的幂 + 下两位决定的1/4级
+        int bits = 0;
+        for (size_t s = (size - 1) >> 8; s != 0; s >>= 1) {
+            ++bits;
+        }
+        size_t base = kMinClassSize << (bits - 1);
+        int quarter = static_cast<int>((size - 1 - base) / (base / 4));
+        return 4 * (bits - 1) + 1 + quarter;
+    }
+
+    size_t PooledAllocator::classSize(int cls) {
+        if (cls == 0) {
+            return kMinClassSize;
+        }
+        int bits = (cls - 1) / 4 + 1;
+        int quarter = (cls - 1) % 4;
+        size_t base = kMinClassSize << (bits - 1);
+        return base + (base / 4) * (quarter + 1);
+    }
+
+    cv::UMatData* PooledAllocator::allocate(int dims, const int* sizes, int type, void* data0,
+        size_t* step, cv::AccessFlag /*flags*/, cv::UMatUsageFlags /*usage_flags*/) const {
+        // 与 OpenCV 标准分配器相同的步长计算
+        size_t total = CV_ELEM_SIZE(type);
+        for (int i = dims - 1; i >= 0; --i) {
+            if (step) {
+                if (data0 && step[i] != CV_AUTOSTEP) {
+                    CV_Assert(total <= step[i]);
+                    total = step[i];
+                }
+                else {
+                    step[i] = total;
+                }
+            }
+            total *= sizes[i];
+        }
+
+        uchar* data = data0 ? static_cast<uchar*>(data0) : static_cast<uchar*>(acquire(total));
+        cv::UMatData* u = new cv::UMatData(this);
+        u->data = u->origdata = data;
+        u->size = total;
+        if (data0) {
+            u->flags |= cv::UMatData::USER_ALLOCATED;
+        }
+        return u;
+    }
+
+    bool PooledAllocator::allocate(cv::UMatData* u, cv::AccessFlag /*access_flags*/,
+        cv::UMatUsageFlags /*usage_flags*/) const {
+        return u != nullptr;
+    }
+
+    void PooledAllocator::deallocate(cv::UMatData* u) const {
+        if (u == nullptr) {
+            return;
+        }
+        CV_Assert(u->urefcount == 0);
+        CV_Assert(u->refcount == 0);
+        if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+            release(u->origdata, u->size);
+            u->origdata = nullptr;
+        }
+        delete u;
+    }
+
+    void* PooledAllocator::acquire(size_t size) const {
+        int cls = sizeClass(size);
+        size_t bytes = classSize(cls);
+        if (cls < kClassCount) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!free_[cls].empty()) {
+                void* ptr = free_[cls].back();
+                free_[cls].pop_back();
+                cached_ -= bytes;
+                hits_++;
+                return ptr;
+            }
+        }
+
+        misses_++;
+        void* ptr = allocateBlock(bytes);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        resident_ += bytes;
+        return ptr;
+    }
+
+    void PooledAllocator::release(void* ptr, size_t size) const {
+        int cls = sizeClass(size);
+        size_t bytes = classSize(cls);
+        if (cls < kClassCount && cached_.load(std::memory_order_relaxed) + bytes <= max_cached_) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_[cls].push_back(ptr);
+            cached_ += bytes;
+            return;
+        }
+        freeBlock(ptr, bytes);
+        resident_ -= bytes;
+    }
+
+    void* PooledAllocator::allocateBlock(size_t size) const {
+        void* ptr = nullptr;
+#ifdef _WIN32
+        ptr = _aligned_malloc(size, kAlignment);
+        if (ptr == nullptr) {
+            return nullptr;
+        }
+#else
+        if (size >= kHugePageMin) {
+            // 大缓冲区直接映射（页对齐），MAP_POPULATE 一次性建立页表
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_POPULATE
+            if (!huge_pages_) {
+                flags |= MAP_POPULATE;
+            }
+#endif
+            ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (ptr == MAP_FAILED) {
+                return nullptr;
+            }
+#ifdef MADV_HUGEPAGE
+            if (huge_pages_) {
+                madvise(ptr, size, MADV_HUGEPAGE);
+            }
+#endif
+        }
+        else if (posix_memalign(&ptr, kAlignment, size) != 0) {
+            return nullptr;
+        }
+#endif
+        // 预先触页：首帧之后不再出现缺页
+        volatile unsigned char* bytes = static_cast<unsigned char*>(ptr);
+        for (size_t offset = 0; offset < size; offset += kPageSize) {
+            bytes[offset] = 0;
+        }
+        return ptr;
+    }
+
+    void PooledAllocator::freeBlock(void* ptr, size_t size) const {
+#ifdef _WIN32
+        (void)size;
+        _aligned_free(ptr);
+#else
+        if (size >= kHugePageMin) {
+            munmap(ptr, size);
+        }
+        else {
+            std::free(ptr);
+        }
+#endif
+    }
+
+    void PooledAllocator::printStats() const {
+        std::cout << "图像分配器: 命中 " << hits() << "，未命中 " << misses()
+            << "，常驻 " << residentBytes() / (1024.0 * 1024.0) << " MB（缓存 "
+            << cachedBytes() / (1024.0 * 1024.0) << " MB）" << std::endl;
+    }
+
+} // namespace AutoAim
\ No newline at end of file
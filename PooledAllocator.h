@@ -0,0 +1,69 @@
+﻿#ifndef POOLED_ALLOCATOR_HPP
+#define POOLED_ALLOCATOR_HPP
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace AutoAim {
+
+    // 流水线图像分配器：按尺寸分级缓存释放的缓冲区，下一帧同尺寸的 cv::Mat 直接复用，
+    // 缓冲区64字节对齐、首次分配时预先触页（可选透明大页），避免每帧的缺页中断。
+    // 作为 OpenCV 默认分配器安装后对所有线程生效，实例永不销毁，保证晚于所有 Mat
+    class PooledAllocator : public cv::MatAllocator {
+    public:
+        // 全局实例
+        static PooledAllocator& instance();
+
+        // 安装为 cv::Mat 默认分配器；huge_pages 为 true 时大缓冲区申请透明大页（Linux）
+        static void install(bool huge_pages);
+
+        cv::UMatData* allocate(int dims, const int* sizes, int type, void* data0,
+            size_t* step, cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const override;
+        bool allocate(cv::UMatData* data, cv::AccessFlag access_flags,
+            cv::UMatUsageFlags usage_flags) const override;
+        void deallocate(cv::UMatData* data) const override;
+
+        // 缓存上限，超出后释放的缓冲区直接归还系统
+        void setMaxCached(size_t bytes) { max_cached_ = bytes; }
+
+        uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+        uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+        size_t residentBytes() const { return resident_.load(std::memory_order_relaxed); }    // 使用中 + 缓存
+        size_t cachedBytes() const { return cached_.load(std::memory_order_relaxed); }
+
+        // 输出统计
+        void printStats() const;
+
+    private:
+        PooledAllocator();
+
+        // 尺寸分级：每个2的幂区间分4级，浪费不超过25%
+        static int sizeClass(size_t size);
+        static size_t classSize(int cls);
+
+        void* acquire(size_t size) const;
+        void release(void* ptr, size_t size) const;
+
+        void* allocateBlock(size_t size) const;
+        void freeBlock(void* ptr, size_t size) const;
+
+    private:
+        static const int kClassCount = 4 * 40;
+
+        mutable std::mutex mutex_;
+        mutable std::vector<void*> free_[kClassCount];
+        bool huge_pages_;
+        size_t max_cached_;
+        mutable std::atomic<uint64_t> hits_;
+        mutable std::atomic<uint64_t> misses_;
+        mutable std::atomic<size_t> resident_;
+        mutable std::atomic<size_t> cached_;
+    };
+
+} // namespace AutoAim
+
+#endif // POOLED_ALLOCATOR_HPP
\ No newline at end of file
@@ -0,0 +1,67 @@
+﻿#include "RowStream.hpp"
+#include <algorithm>
+
+namespace AutoAim {
+
+    SyntheticBandSource::SyntheticBandSource(int band_rows, double readout_ms)
+        : band_rows_(std::max(band_rows, 1)),
+        readout_ms_(readout_ms),
+        rows_ready_(0),
+        rows_reported_(0) {
+    }
+
+    SyntheticBandSource::~SyntheticBandSource() {
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    cv::Mat SyntheticBandSource::start(const cv::Mat& frame) {
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+
+        source_ = frame;
+        buffer_.create(frame.size(), frame.type());
+        rows_ready_ = 0;
+        rows_reported_ = 0;
+        thread_ = std::thread(&SyntheticBandSource::fill, this);
+        return buffer_;
+    }
+
+    void SyntheticBandSource::fill() {
+        const int rows = source_.rows;
+        const auto begin = std::chrono::steady_clock::now();
+
+        for (int first = 0; first < rows; first += band_rows_) {
+            int last = std::min(first + band_rows_, rows);
+
+            // 按读出速率等到本带最后一行读出
+            auto due = begin + std::chrono::microseconds(
+                static_cast<int64_t>(readout_ms_ * 1000.0 * last / rows));
+            std::this_thread::sleep_until(due);
+
+            source_.rowRange(first, last).copyTo(buffer_.rowRange(first, last));
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            rows_ready_ = last;
+            if (last == rows) {
+                complete_time_ = std::chrono::steady_clock::now();
+            }
+            cond_.notify_one();
+        }
+    }
+
+    int SyntheticBandSource::waitRows() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return rows_ready_ > rows_reported_; });
+        rows_reported_ = rows_ready_;
+        return rows_ready_;
+    }
+
+    std::chrono::steady_clock::time_point SyntheticBandSource::completeTime() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return complete_time_;
+    }
+
+} // namespace AutoAim
\ No newline at end of file
@@ -0,0 +1,55 @@
+﻿#ifndef ROW_STREAM_HPP
+#define ROW_STREAM_HPP
+
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace AutoAim {
+
+    // 按行到达的帧源：帧缓冲区自上而下逐步写满（相机读出/DMA传输）
+    class RowStreamSource {
+    public:
+        virtual ~RowStreamSource() {}
+
+        // 阻塞直到当前帧有新行写入，返回已写入的缓冲区行数；等于缓冲区行数时整帧完成
+        virtual int waitRows() = 0;
+    };
+
+    // 合成分带源：把完整的帧按固定行数分带写入缓冲区，
+    // 带与带之间按读出时间等待，模拟传感器自上而下的读出过程
+    class SyntheticBandSource : public RowStreamSource {
+    public:
+        // band_rows: 每带行数；readout_ms: 整帧读出时间
+        SyntheticBandSource(int band_rows, double readout_ms);
+        ~SyntheticBandSource();
+
+        // 开始流式写入一帧，返回正在写入的缓冲区（下一次 start 前保持有效）
+        cv::Mat start(const cv::Mat& frame);
+
+        int waitRows() override;
+
+        // 当前帧最后一带写入的时刻
+        std::chrono::steady_clock::time_point completeTime();
+
+    private:
+        void fill();
+
+    private:
+        int band_rows_;
+        double readout_ms_;
+        cv::Mat source_;            // 完整的帧
+        cv::Mat buffer_;            // 逐带写入的缓冲区
+        std::thread thread_;
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        int rows_ready_;            // 已写入行数
+        int rows_reported_;         // 已通知给消费者的行数
+        std::chrono::steady_clock::time_point complete_time_;
+    };
+
+} // namespace AutoAim
+
+#endif // ROW_STREAM_HPP
\ No newline at end of file
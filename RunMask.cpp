@@ -0,0 +1,320 @@
+﻿#include "RunMask.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+
+namespace AutoAim {
+
+    namespace {
+        typedef std::pair<int, int> Span;
+
+        // 两个有序不相交区间列表求交
+        void intersectSpans(const std::vector<Span>& a, const std::vector<Span>& b, std::vector<Span>& out) {
+            out.clear();
+            size_t i = 0, j = 0;
+            while (i < a.size() && j < b.size()) {
+                int start = std::max(a[i].first, b[j].first);
+                int end = std::min(a[i].second, b[j].second);
+                if (start < end) {
+                    out.push_back(Span(start, end));
+                }
+                if (a[i].second < b[j].second) ++i; else ++j;
+            }
+        }
+    }
+
+    RunMask::RunMask() : rows_(0), cols_(0) {
+        row_start_.push_back(0);
+    }
+
+    RunMask::RunMask(int rows, int cols) {
+        reset(rows, cols);
+    }
+
+    void RunMask::reset(int rows, int cols) {
+        rows_ = rows;
+        cols_ = cols;
+        runs_.clear();
+        row_start_.clear();
+        row_start_.reserve(rows + 1);
+        row_start_.push_back(0);
+    }
+
+    void RunMask::addRun(int start, int end) {
+        MaskRun run;
+        run.row = static_cast<int>(row_start_.size()) - 1;
+        run.start = start;
+        run.end = end;
+        runs_.push_back(run);
+    }
+
+    void RunMask::endRow() {
+        row_start_.push_back(static_cast<int>(runs_.size()));
+    }
+
+    void RunMask::appendRow(const uchar* row) {
+        int c = 0;
+        while (c < cols_) {
+            // 背景占绝大多数，按8字节跳过
+            while (c + 8 <= cols_) {
+                uint64_t word;
+                std::memcpy(&word, row + c, sizeof(word));
+                if (word != 0) break;
+                c += 8;
+            }
+            while (c < cols_ && row[c] == 0) ++c;
+            if (c >= cols_) break;
+
+            int start = c;
+            while (c < cols_ && row[c] != 0) ++c;
+            addRun(start, c);
+        }
+        endRow();
+    }
+
+    RunMask RunMask::fromMat(const cv::Mat& binary) {
+        CV_Assert(binary.type() == CV_8UC1);
+        RunMask mask(binary.rows, binary.cols);
+        for (int r = 0; r < binary.rows; ++r) {
+            mask.appendRow(binary.ptr<uchar>(r));
+        }
+        return mask;
+    }
+
+    cv::Mat RunMask::toMat() const {
+        cv::Mat binary = cv::Mat::zeros(rows_, cols_, CV_8UC1);
+        for (const auto& run : runs_) {
+            std::memset(binary.ptr<uchar>(run.row) + run.start, 255, run.end - run.start);
+        }
+        return binary;
+    }
+
+    int RunMask::area() const {
+        int total = 0;
+        for (const auto& run : runs_) {
+            total += run.end - run.start;
+        }
+        return total;
+    }
+
+    void RunMask::erode3x3(RunMask& out) const {
+        out.reset(rows_, cols_);
+        for (int r = 0; r < rows_; ++r) {
+            erodeRow(r, out);
+        }
+    }
+
+    void RunMask::dilate3x3(RunMask& out) const {
+        out.reset(rows_, cols_);
+        for (int r = 0; r < rows_; ++r) {
+            dilateRow(r, out);
+        }
+    }
+
+    void RunMask::erodeRow(int r, RunMask& out) const {
+        // 水平腐蚀，图像外按前景处理（与 cv::erode 默认边界一致）
+        auto horizontal = [this](int row, std::vector<Span>& spans) {
+            spans.clear();
+            for (const MaskRun* run = rowBegin(row); run != rowEnd(row); ++run) {
+                int start = run->start == 0 ? 0 : run->start + 1;
+                int end = run->end == cols_ ? cols_ : run->end - 1;
+                if (start < end) {
+                    spans.push_back(Span(start, end));
+                }
+            }
+        };
+
+        // 垂直腐蚀：与上下两行求交
+        std::vector<Span> result, neighbor, tmp;
+        horizontal(r, result);
+        if (r > 0) {
+            horizontal(r - 1, neighbor);
+            intersectSpans(result, neighbor, tmp);
+            result.swap(tmp);
+        }
+        if (r + 1 < rows_) {
+            horizontal(r + 1, neighbor);
+            intersectSpans(result, neighbor, tmp);
+            result.swap(tmp);
+        }
+        for (const auto& span : result) {
+            out.addRun(span.first, span.second);
+        }
+        out.endRow();
+    }
+
+    void RunMask::dilateRow(int r, RunMask& out) const {
+        // 上中下三行水平膨胀后的并集，图像外按背景处理
+        std::vector<Span> spans;
+        for (int rr = std::max(r - 1, 0); rr <= std::min(r + 1, rows_ - 1); ++rr) {
+            for (const MaskRun* run = rowBegin(rr); run != rowEnd(rr); ++run) {
+                spans.push_back(Span(std::max(run->start - 1, 0), std::min(run->end + 1, cols_)));
+            }
+        }
+        std::sort(spans.begin(), spans.end());
+
+        size_t i = 0;
+        while (i < spans.size()) {
+            int start = spans[i].first;
+            int end = spans[i].second;
+            for (++i; i < spans.size() && spans[i].first <= end; ++i) {
+                end = std::max(end, spans[i].second);
+            }
+            out.addRun(start, end);
+        }
+        out.endRow();
+    }
+
+    void RunMask::refine() {
+        RunMask eroded, opened;
+        erode3x3(eroded);
+        eroded.dilate3x3(opened);
+        opened.dilate3x3(*this);
+    }
+
+    std::vector<MaskComponent> RunMask::components() const {
+        const int n = runCount();
+        std::vector<int> parent(n);
+        std::iota(parent.begin(), parent.end(), 0);
+
+        auto find = [&parent](int x) {
+            while (parent[x] != x) {
+                parent[x] = parent[parent[x]];
+                x = parent[x];
+            }
+            return x;
+        };
+
+        // 相邻两行的段两两扫描，8邻接即合并
+        for (int r = 0; r + 1 < rows_; ++r) {
+            int i = row_start_[r], i_end = row_start_[r + 1];
+            int j = row_start_[r + 1], j_end = row_start_[r + 2];
+            while (i < i_end && j < j_end) {
+                const MaskRun& a = runs_[i];
+                const MaskRun& b = runs_[j];
+                if (a.start <= b.end && b.start <= a.end) {
+                    int ra = find(i), rb = find(j);
+                    if (ra != rb) {
+                        parent[std::max(ra, rb)] = std::min(ra, rb);
+                    }
+                }
+                if (a.end < b.end) ++i; else ++j;
+            }
+        }
+
+        // 按首段的光栅顺序编号
+        std::vector<MaskComponent> components;
+        std::vector<int> index(n, -1);
+        for (int k = 0; k < n; ++k) {
+            int root = find(k);
+            if (index[root] < 0) {
+                index[root] = static_cast<int>(components.size());
+                components.push_back(MaskComponent());
+                components.back().area = 0;
+            }
+            MaskComponent& component = components[index[root]];
+            const MaskRun& run = runs_[k];
+            cv::Rect span(run.start, run.row, run.end - run.start, 1);
+            component.box = component.runs.empty() ? span : (component.box | span);
+            component.area += run.end - run.start;
+            component.runs.push_back(k);
+        }
+
+        return components;
+    }
+
+    void ComponentTracker::reset() {
+        parent_.clear();
+        members_.clear();
+        previous_roots_.clear();
+    }
+
+    int ComponentTracker::find(int x) {
+        while (parent_[x] != x) {
+            parent_[x] = parent_[parent_[x]];
+            x = parent_[x];
+        }
+        return x;
+    }
+
+    void ComponentTracker::addRow(const RunMask& mask, int r, std::vector<MaskComponent>& closed) {
+        const int begin = mask.rowStart(r);
+        const int end = mask.rowStart(r + 1);
+        for (int k = begin; k < end; ++k) {
+            parent_.push_back(k);
+            members_.push_back(std::vector<int>(1, k));
+        }
+
+        // 与上一行8邻接的段合并，根取较小下标（光栅序首段），成员表小并入大
+        if (r > 0) {
+            const std::vector<MaskRun>& runs = mask.runs();
+            int i = mask.rowStart(r - 1);
+            int j = begin;
+            while (i < begin && j < end) {
+                const MaskRun& a = runs[i];
+                const MaskRun& b = runs[j];
+                if (a.start <= b.end && b.start <= a.end) {
+                    int ra = find(i), rb = find(j);
+                    if (ra != rb) {
+                        int root = std::min(ra, rb), child = std::max(ra, rb);
+                        if (members_[root].size() < members_[child].size()) {
+                            members_[root].swap(members_[child]);
+                        }
+                        members_[root].insert(members_[root].end(), members_[child].begin(), members_[child].end());
+                        std::vector<int>().swap(members_[child]);
+                        parent_[child] = root;
+                    }
+                }
+                if (a.end < b.end) ++i; else ++j;
+            }
+        }
+
+        std::vector<int> roots;
+        for (int k = begin; k < end; ++k) {
+            roots.push_back(find(k));
+        }
+        std::sort(roots.begin(), roots.end());
+        roots.erase(std::unique(roots.begin(), roots.end()), roots.end());
+
+        // 上一行出现而本行未出现的连通域已封闭
+        for (int previous : previous_roots_) {
+            int root = find(previous);
+            if (!std::binary_search(roots.begin(), roots.end(), root)) {
+                close(mask, root, closed);
+            }
+        }
+        previous_roots_.swap(roots);
+    }
+
+    void ComponentTracker::finish(const RunMask& mask, std::vector<MaskComponent>& closed) {
+        for (int root : previous_roots_) {
+            close(mask, find(root), closed);
+        }
+        previous_roots_.clear();
+    }
+
+    void ComponentTracker::close(const RunMask& mask, int root, std::vector<MaskComponent>& closed) {
+        MaskComponent component;
+        component.area = 0;
+        component.runs.swap(members_[root]);
+        for (size_t i = 0; i < component.runs.size(); ++i) {
+            const MaskRun& run = mask.runs()[component.runs[i]];
+            cv::Rect span(run.start, run.row, run.end - run.start, 1);
+            component.box = i == 0 ? span : (component.box | span);
+            component.area += run.end - run.start;
+        }
+        closed.push_back(component);
+    }
+
+    cv::Mat RunMask::renderComponent(const MaskComponent& component, int pad) const {
+        cv::Mat roi = cv::Mat::zeros(component.box.height + 2 * pad, component.box.width + 2 * pad, CV_8UC1);
+        for (int k : component.runs) {
+            const MaskRun& run = runs_[k];
+            std::memset(roi.ptr<uchar>(run.row - component.box.y + pad) + run.start - component.box.x + pad,
+                255, run.end - run.start);
+        }
+        return roi;
+    }
+
+} // namespace AutoAim
\ No newline at end of file
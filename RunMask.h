@@ -0,0 +1,102 @@
+﻿#ifndef RUN_MASK_HPP
+#define RUN_MASK_HPP
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+namespace AutoAim {
+
+    // 一段连续前景像素 [start, end)
+    struct MaskRun {
+        int row;
+        int start;
+        int end;
+    };
+
+    // 连通域（8邻接），runs 为 RunMask 中的下标
+    struct MaskComponent {
+        cv::Rect box;
+        int area;
+        std::vector<int> runs;
+    };
+
+    // 行程编码的稀疏二值掩码：按行存储前景段，内存与点亮面积成正比
+    class RunMask {
+    public:
+        RunMask();
+        RunMask(int rows, int cols);
+
+        // 清空并设置尺寸
+        void reset(int rows, int cols);
+
+        // 按行顺序构建：addRun 添加当前行的段（按start递增），endRow 结束当前行
+        void addRun(int start, int end);
+        void endRow();
+
+        // 编码一行0/非0像素并结束该行
+        void appendRow(const uchar* row);
+
+        // 稠密掩码互转
+        static RunMask fromMat(const cv::Mat& binary);
+        cv::Mat toMat() const;
+
+        int rows() const { return rows_; }
+        int cols() const { return cols_; }
+        int rowsAppended() const { return static_cast<int>(row_start_.size()) - 1; }
+        int rowStart(int r) const { return row_start_[r]; }
+        int runCount() const { return static_cast<int>(runs_.size()); }
+        int area() const;
+
+        const std::vector<MaskRun>& runs() const { return runs_; }
+        const MaskRun* rowBegin(int r) const { return runs_.data() + row_start_[r]; }
+        const MaskRun* rowEnd(int r) const { return runs_.data() + row_start_[r + 1]; }
+
+        // 3x3矩形核形态学，边界处理与 cv::erode / cv::dilate 默认值一致
+        void erode3x3(RunMask& out) const;
+        void dilate3x3(RunMask& out) const;
+
+        // 逐行计算（流式）：输出第 r 行并追加到 out
+        // 需要第 r+1 行已追加，或 r 为最后一行
+        void erodeRow(int r, RunMask& out) const;
+        void dilateRow(int r, RunMask& out) const;
+
+        // 开运算后再膨胀（与 LightBarDetector::refineMask 相同）
+        void refine();
+
+        // 提取8邻接连通域
+        std::vector<MaskComponent> components() const;
+
+        // 将连通域绘制到 box 外扩 pad 像素的局部掩码中
+        cv::Mat renderComponent(const MaskComponent& component, int pad) const;
+
+    private:
+        int rows_;
+        int cols_;
+        std::vector<MaskRun> runs_;
+        std::vector<int> row_start_;    // 每行第一段的下标，长度 rows_ + 1
+    };
+
+    // 流式连通域提取：逐行合并，连通域在下一行没有与之相连的段时即不会再增长，立即输出
+    class ComponentTracker {
+    public:
+        void reset();
+
+        // mask 已追加第 r 行，合并后输出已封闭的连通域
+        void addRow(const RunMask& mask, int r, std::vector<MaskComponent>& closed);
+
+        // 帧结束，输出剩余连通域
+        void finish(const RunMask& mask, std::vector<MaskComponent>& closed);
+
+    private:
+        int find(int x);
+        void close(const RunMask& mask, int root, std::vector<MaskComponent>& closed);
+
+    private:
+        std::vector<int> parent_;
+        std::vector<std::vector<int>> members_;     // 根节点持有连通域内全部段
+        std::vector<int> previous_roots_;           // 上一行出现的连通域
+    };
+
+} // namespace AutoAim
+
+#endif // RUN_MASK_HPP
\ No newline at end of file
@@ -0,0 +1,173 @@
+﻿// 共享内存检测结果发布延迟测试：读端按发布的相机内参对每个装甲板瞄准解算，计入延迟
+// 用法: shm_latency_bench [--role both|pub|sub] [--frames N] [--rate Hz] [--name 名称]
+//   both（默认，仅POSIX）：fork出读进程；Windows下分别在两个进程中运行 pub 和 sub
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Aimer.hpp"
+#include "DetectionShm.hpp"
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace AutoAim;
+
+namespace {
+
+    struct BenchConfig {
+        std::string role;
+        std::string name;
+        int frames;
+        double rate;
+
+        BenchConfig() : role("both"), name("auto_aim_bench"), frames(10000), rate(1000.0) {}
+    };
+
+    int runPublisher(const BenchConfig& config, DetectionWriter& writer) {
+        // 等待读端就绪
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+        int64_t period_ns = static_cast<int64_t>(1e9 / config.rate);
+        int64_t next = shmNowNs();
+
+        for (int i = 0; i < config.frames; ++i) {
+            while (shmNowNs() < next) {
+                std::this_thread::yield();
+            }
+            next += period_ns;
+
+            ShmFrame* frame = writer.beginWrite();
+            frame->frame_index = i;
+            frame->count = 4;
+            for (uint32_t k = 0; k < frame->count; ++k) {
+                // 约3米处的小装甲板，沿水平方向排开
+                ShmArmor& armor = frame->armors[k];
+                std::memset(&armor, 0, sizeof(ShmArmor));
+                float x = 300.0f + 200.0f * k;
+                armor.left = { x, 500.0f, 6.0f, 22.0f, 0.0f };
+                armor.right = { x + 55.0f, 500.0f, 6.0f, 22.0f, 0.0f };
+                armor.number = static_cast<int32_t>(k + 1);
+            }
+            frame->timestamp_ns = shmNowNs();
+            writer.endWrite();
+        }
+
+        // 等待读端读完再释放共享内存
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        return 0;
+    }
+
+    int runReader(const BenchConfig& config) {
+        DetectionReader reader;
+        for (int retry = 0; retry < 100 && !reader.open(config.name); ++retry) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+
+        Aimer aimer;
+        ShmCamera camera;
+        if (reader.camera(camera)) {
+            aimer.setCamera(camera);
+        }
+        else {
+            std::cerr << "警告: 写端未发布相机内参，不做瞄准解算" << std::endl;
+        }
+
+        std::vector<double> latencies;
+        latencies.reserve(config.frames);
+        uint64_t last_index = 0;
+        int missed = 0;
+        uint64_t aimed = 0;
+
+        ShmFrame frame;
+        while (static_cast<int>(latencies.size()) < config.frames) {
+            if (!reader.waitNext(frame, 2000000)) {
+                break;
+            }
+            for (uint32_t k = 0; k < frame.count; ++k) {
+                aimed += aimer.aim(frame.armors[k]).valid ? 1 : 0;
+            }
+            int64_t now = shmNowNs();
+            if (!latencies.empty() && frame.frame_index > last_index + 1) {
+                missed += static_cast<int>(frame.frame_index - last_index - 1);
+            }
+            last_index = frame.frame_index;
+            latencies.push_back((now - frame.timestamp_ns) / 1000.0);
+            if (frame.frame_index + 1 >= static_cast<uint64_t>(config.frames)) {
+                break;
+            }
+        }
+
+        if (latencies.empty()) {
+            std::cerr << "错误: 未读取到任何帧" << std::endl;
+            return -1;
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        size_t n = latencies.size();
+        std::cout << "读取帧数: " << n << "，丢失: " << missed << "，有效瞄准解: " << aimed << std::endl;
+        std::cout << "延迟(us) p50: " << latencies[n / 2]
+            << "  p99: " << latencies[std::min(n - 1, n * 99 / 100)]
+            << "  max: " << latencies[n - 1] << std::endl;
+        return 0;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--role" && i + 1 < argc) {
+            config.role = argv[++i];
+        }
+        else if (arg == "--frames" && i + 1 < argc) {
+            config.frames = std::atoi(argv[++i]);
+        }
+        else if (arg == "--rate" && i + 1 < argc) {
+            config.rate = std::atof(argv[++i]);
+        }
+        else if (arg == "--name" && i + 1 < argc) {
+            config.name = argv[++i];
+        }
+    }
+
+    if (config.role == "sub") {
+        return runReader(config);
+    }
+
+    // 先创建共享内存，读进程启动后即可打开
+    DetectionWriter writer;
+    ShmCamera camera = { 1200.0, 1200.0, 640.0, 512.0 };
+    if (!writer.create(config.name, &camera)) {
+        return -1;
+    }
+
+    if (config.role == "pub") {
+        return runPublisher(config, writer);
+    }
+
+#ifdef _WIN32
+    std::cerr << "Windows下请分别以 --role pub 和 --role sub 启动两个进程" << std::endl;
+    return -1;
+#else
+    pid_t pid = fork();
+    if (pid == 0) {
+        // 子进程不能析构继承来的写端（会删除共享内存）
+        int ret = runReader(config);
+        std::cout.flush();
+        _exit(ret);
+    }
+    int ret = runPublisher(config, writer);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return ret != 0 ? ret : WEXITSTATUS(status);
+#endif
+}
\ No newline at end of file
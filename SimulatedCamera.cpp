@@ -0,0 +1,126 @@
+﻿#include "SimulatedCamera.hpp"
+#include "DetectionShm.hpp"
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace AutoAim {
+
+    SimulatedCamera::SimulatedCamera(cv::VideoCapture& cap, double fps, int buffer_size, double jitter_ms)
+        : cap_(cap),
+        fps_(fps),
+        jitter_ms_(std::max(jitter_ms, 0.0)),
+        slots_(std::max(buffer_size, 1)),
+        head_(0),
+        count_(0),
+        finished_(false),
+        running_(false),
+        captured_(0),
+        delivered_(0),
+        overwritten_(0),
+        skipped_(0),
+        age_total_ms_(0.0),
+        age_max_ms_(0.0) {
+        if (fps_ <= 0.0) {
+            fps_ = cap_.get(cv::CAP_PROP_FPS);
+        }
+        if (fps_ <= 0.0) {
+            fps_ = 30.0;
+        }
+    }
+
+    SimulatedCamera::~SimulatedCamera() {
+        stop();
+    }
+
+    void SimulatedCamera::start() {
+        if (thread_.joinable()) {
+            return;
+        }
+        running_ = true;
+        thread_ = std::thread(&SimulatedCamera::run, this);
+    }
+
+    void SimulatedCamera::stop() {
+        running_ = false;
+        cond_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void SimulatedCamera::run() {
+        typedef std::chrono::steady_clock Clock;
+        const auto interval = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / fps_));
+        std::mt19937 rng(12345);
+        std::uniform_real_distribution<double> jitter(-jitter_ms_, jitter_ms_);
+
+        auto next = Clock::now() + interval;
+        while (running_) {
+            // 先解码，再等到采集时刻：解码时间被帧间隔吸收
+            cv::Mat frame;
+            cap_ >> frame;
+            if (frame.empty()) {
+                break;
+            }
+
+            const auto offset = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double, std::milli>(jitter_ms_ > 0.0 ? jitter(rng) : 0.0));
+            auto due = next + offset;
+
+            // 解码慢于帧间隔：真实传感器不会补发错过的帧，跳过已过去的采集时刻并计数，
+            // 本帧在下一个采集时刻产出，而不是按旧时间表连续补采造成突发
+            auto now = Clock::now();
+            if (now > due) {
+                auto missed = std::max<Clock::rep>(0, (now - next) / interval) + 1;
+                skipped_ += static_cast<uint64_t>(missed);
+                next += interval * missed;
+                due = next + offset;
+            }
+            std::this_thread::sleep_until(due);
+            next += interval;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (count_ == slots_.size()) {
+                // 缓冲区满：覆盖最旧的帧
+                head_ = (head_ + 1) % slots_.size();
+                count_--;
+                overwritten_++;
+            }
+            Slot& slot = slots_[(head_ + count_) % slots_.size()];
+            slot.frame = frame;
+            slot.capture_ns = shmNowNs();
+            count_++;
+            captured_++;
+            cond_.notify_one();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = true;
+        cond_.notify_all();
+    }
+
+    bool SimulatedCamera::read(cv::Mat& frame, int64_t& capture_ns) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return count_ > 0 || finished_ || !running_; });
+        if (count_ == 0) {
+            return false;
+        }
+
+        // 交出帧后槽位不再引用该缓冲区，下一帧解码到新缓冲区，不会改写检测中的图像
+        Slot& slot = slots_[head_];
+        frame = slot.frame;
+        slot.frame = cv::Mat();
+        capture_ns = slot.capture_ns;
+        head_ = (head_ + 1) % slots_.size();
+        count_--;
+        delivered_++;
+
+        double age_ms = (shmNowNs() - capture_ns) / 1e6;
+        age_total_ms_ += age_ms;
+        age_max_ms_ = std::max(age_max_ms_, age_ms);
+        return true;
+    }
+
+} // namespace AutoAim
\ No newline at end of file
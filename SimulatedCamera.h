@@ -0,0 +1,76 @@
+﻿#ifndef SIMULATED_CAMERA_HPP
+#define SIMULATED_CAMERA_HPP
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AutoAim {
+
+    // 模拟相机：按自身时钟以固定帧率回放视频文件，帧进入有界的驱动缓冲区，
+    // 缓冲区满时覆盖最旧的帧（与工业相机SDK的覆盖模式一致）。
+    // 检测跟不上时会出现积压、丢帧和帧龄增长，与实机行为相同
+    class SimulatedCamera {
+    public:
+        // fps <= 0 时使用文件自身帧率；buffer_size 为驱动缓冲帧数；
+        // jitter_ms 为每帧采集时刻的随机抖动幅度（均匀分布 ±jitter_ms）
+        SimulatedCamera(cv::VideoCapture& cap, double fps, int buffer_size, double jitter_ms);
+        ~SimulatedCamera();
+
+        // 启动采集线程
+        void start();
+
+        // 停止采集
+        void stop();
+
+        // 按到达顺序取出最旧的一帧，缓冲区空时阻塞；文件播完且缓冲区取空后返回false
+        // capture_ns 为该帧的采集时刻（shmNowNs 时钟）
+        bool read(cv::Mat& frame, int64_t& capture_ns);
+
+        // 统计在 stop() 之后读取
+        double fps() const { return fps_; }
+        uint64_t captured() const { return captured_; }          // 已采集帧数
+        uint64_t delivered() const { return delivered_; }        // 已交付帧数
+        uint64_t overwritten() const { return overwritten_; }    // 未被取走即被覆盖的帧数
+        uint64_t skipped() const { return skipped_; }            // 解码慢于帧间隔而跳过的采集时刻数
+
+        // 取帧时的帧龄（采集到被取走）
+        double meanAgeMs() const { return delivered_ > 0 ? age_total_ms_ / delivered_ : 0.0; }
+        double maxAgeMs() const { return age_max_ms_; }
+
+    private:
+        void run();
+
+        struct Slot {
+            cv::Mat frame;
+            int64_t capture_ns;
+        };
+
+    private:
+        cv::VideoCapture& cap_;
+        double fps_;
+        double jitter_ms_;
+        std::vector<Slot> slots_;       // 环形缓冲区
+        size_t head_;                   // 最旧一帧的位置
+        size_t count_;                  // 缓冲帧数
+        bool finished_;                 // 文件已播完
+        std::atomic<bool> running_;
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        std::thread thread_;
+
+        uint64_t captured_;
+        uint64_t delivered_;
+        uint64_t overwritten_;
+        uint64_t skipped_;
+        double age_total_ms_;
+        double age_max_ms_;
+    };
+
+} // namespace AutoAim
+
+#endif // SIMULATED_CAMERA_HPP
\ No newline at end of file
@@ -1,13 +1,37 @@
 #include "Utils.hpp"
+#include "Logger.hpp"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <chrono>
 #include <ctime>
 #include <cstring>
+#include <algorithm>
+#include <stdexcept>
 
 namespace AutoAim {
 
+    namespace {
+        // BT.601 ޷Χ루Y 16-235UV 16-240 COLOR_YUV2BGR_YUYV/NV12 ĽϵӦ
+        inline uchar bt601Luma(const uchar* p) {
+            return static_cast<uchar>(((66 * p[2] + 129 * p[1] + 25 * p[0] + 128) >> 8) + 16);
+        }
+
+        // ɫȰۼӣŴ256ƫãӲȡƽ
+        inline int bt601U(const uchar* p) {
+            return -38 * p[2] - 74 * p[1] + 112 * p[0];
+        }
+
+        inline int bt601V(const uchar* p) {
+            return 112 * p[2] - 94 * p[1] - 18 * p[0];
+        }
+
+        // n صɫȺȡƽƫ128룬ӺΪ
+        inline uchar chromaAverage(int sum, int n) {
+            return static_cast<uchar>((sum + (128 + 256 * 128) * n) / (256 * n));
+        }
+    }
+
     // в
     Config Utils::parseArguments(int argc, char** argv) {
         Config config;
@@ -23,13 +47,31 @@ namespace AutoAim {
             }
             else if (arg == "--enemy_color" && i + 1 < argc) {
                 std::string color = argv[++i];
-                if (color == "red" || color == "blue") {
+                if (color == "red" || color == "blue" || color == "both") {
                     config.enemy_color = color;
                 }
                 else {
-                    std::cerr << ": ɫ 'red'  'blue'ʹĬֵ: red" << std::endl;
+                    std::cerr << ": ɫ 'red''blue'  'both'ʹĬֵ: red" << std::endl;
+                }
+            }
+            else if (arg == "--input_format" && i + 1 < argc) {
+                std::string format = argv[++i];
+                if (format == "bgr") {
+                    config.input_format = PixelFormat::BGR;
+                }
+                else if (format == "yuyv") {
+                    config.input_format = PixelFormat::YUYV;
+                }
+                else if (format == "nv12") {
+                    config.input_format = PixelFormat::NV12;
+                }
+                else {
+                    std::cerr << ": ʽ 'bgr''yuyv'  'nv12'ʹĬֵ: bgr" << std::endl;
                 }
             }
+            else if (arg == "--validate_yuv") {
+                config.validate_yuv = true;
+            }
             else if (arg == "--camera" && i + 1 < argc) {
                 config.camera_id = std::stoi(argv[++i]);
             }
@@ -39,6 +81,90 @@ namespace AutoAim {
             else if (arg == "--no-show") {
                 config.show_result = false;
             }
+            else if (arg == "--display_fps" && i + 1 < argc) {
+                config.display_fps = std::stod(argv[++i]);
+            }
+            else if (arg == "--preview_scale" && i + 1 < argc) {
+                config.preview_scale = std::stod(argv[++i]);
+            }
+            else if (arg == "--shm" && i + 1 < argc) {
+                config.shm_name = argv[++i];
+            }
+            else if (arg == "--log" && i + 1 < argc) {
+                config.log_path = argv[++i];
+            }
+            else if (arg == "--adaptive") {
+                config.adaptive_threshold = true;
+            }
+            else if (arg == "--sparse_mask") {
+                config.sparse_mask = true;
+            }
+            else if (arg == "--bright_first") {
+                config.brightness_first = true;
+            }
+            else if (arg == "--color_lut" && i + 1 < argc) {
+                config.color_lut_path = argv[++i];
+            }
+            else if (arg == "--stream_bands" && i + 1 < argc) {
+                config.stream_bands = std::stoi(argv[++i]);
+            }
+            else if (arg == "--readout_ms" && i + 1 < argc) {
+                config.readout_ms = std::stod(argv[++i]);
+            }
+            else if (arg == "--sim_camera") {
+                config.sim_camera = true;
+            }
+            else if (arg == "--sim_fps" && i + 1 < argc) {
+                config.sim_fps = std::stod(argv[++i]);
+            }
+            else if (arg == "--sim_buffer" && i + 1 < argc) {
+                config.sim_buffer = std::stoi(argv[++i]);
+            }
+            else if (arg == "--sim_jitter" && i + 1 < argc) {
+                config.sim_jitter_ms = std::stod(argv[++i]);
+            }
+            else if (arg == "--record" && i + 1 < argc) {
+                config.record_dir = argv[++i];
+            }
+            else if (arg == "--record_seconds" && i + 1 < argc) {
+                config.record_seconds = std::stod(argv[++i]);
+            }
+            else if (arg == "--offline") {
+                config.offline = true;
+            }
+            else if (arg == "--workers" && i + 1 < argc) {
+                config.workers = std::stoi(argv[++i]);
+            }
+            else if (arg == "--gop" && i + 1 < argc) {
+                config.gop_size = std::stoi(argv[++i]);
+            }
+            else if (arg == "--results" && i + 1 < argc) {
+                config.results_path = argv[++i];
+            }
+            else if (arg == "--golden_record" && i + 1 < argc) {
+                config.golden_record = argv[++i];
+            }
+            else if (arg == "--golden_check" && i + 1 < argc) {
+                config.golden_check = argv[++i];
+            }
+            else if (arg == "--bundle" && i + 1 < argc) {
+                config.bundle_path = argv[++i];
+            }
+            else if (arg == "--pool_alloc") {
+                config.pool_allocator = true;
+            }
+            else if (arg == "--huge_pages") {
+                config.huge_pages = true;
+            }
+            else if (arg == "--hot_reload") {
+                config.hot_reload = true;
+            }
+            else if (arg == "--make_bundle" && i + 1 < argc) {
+                config.make_bundle = argv[++i];
+            }
+            else if (arg == "--calib" && i + 1 < argc) {
+                config.calib_path = argv[++i];
+            }
             else if (arg == "--save") {
                 config.save_result = true;
             }
@@ -47,16 +173,51 @@ namespace AutoAim {
                 std::cout << "ѡ:" << std::endl;
                 std::cout << "  --input <·>         Ƶļ·" << std::endl;
                 std::cout << "  --output <·>        Ƶļ· (Ĭ: output.mp4)" << std::endl;
-                std::cout << "  --enemy_color <ɫ>   зɫ: red  blue (Ĭ: red)" << std::endl;
+                std::cout << "  --enemy_color <ɫ>   зɫ: redblue  both (Ĭ: red)" << std::endl;
+                std::cout << "  --input_format <ʽ>  ʽ: bgryuyv  nv12 (Ĭ: bgr)" << std::endl;
+                std::cout << "  --validate_yuv         ԱYUVBGRָƵļ룩" << std::endl;
                 std::cout << "  --camera <ID>          ͷID (Ĭ: 0)" << std::endl;
                 std::cout << "  --show                 ʾ (Ĭ)" << std::endl;
                 std::cout << "  --no-show              ʾ" << std::endl;
+                std::cout << "  --display_fps <֡>   Ԥˢ (Ĭ: 30)" << std::endl;
+                std::cout << "  --preview_scale <> Ԥͼű (Ĭ: 0.5)" << std::endl;
+                std::cout << "  --shm <>           ڴ" << std::endl;
+                std::cout << "  --log <·>           ׷дʽ־detection_log_query ѯ" << std::endl;
+                std::cout << "  --adaptive             ݻӦֵع⣻ұָӰ죩" << std::endl;
+                std::cout << "  --sparse_mask          ָʹг̱̬ѧͨ" << std::endl;
+                std::cout << "  --bright_first         Ȱȷָֻںѡں˶ɫBGRɫ" << std::endl;
+                std::cout << "  --color_lut <·>     ʹñ궨ɫұָcolor_lut_calib ɣ" << std::endl;
+                std::cout << "  --stream_bands <>  ģж߽ձ߼⣨Ƶļ룬֧ --bright_first" << std::endl;
+                std::cout << "  --readout_ms <>    ʽģ֡ʱ (Ĭ: 8)" << std::endl;
+                std::cout << "  --sim_camera           Ƶļʵʱ֡ʻطţģ塢֡" << std::endl;
+                std::cout << "  --sim_fps <֡>       ģ֡ (Ĭ: ļ֡)" << std::endl;
+                std::cout << "  --sim_buffer <N>       ģ֡ (Ĭ: 3)" << std::endl;
+                std::cout << "  --sim_jitter <>    ģɼʱ̶ (Ĭ: 0)" << std::endl;
+                std::cout << "  --record <Ŀ¼>        ڴб֡мDSIGUSR1Ŀ궪ʧʱת" << std::endl;
+                std::cout << "  --record_seconds <>  м¼ʱ (Ĭ: 3)" << std::endl;
+                std::cout << "  --offline              ߷ֿ鲢дƵļ" << std::endl;
+                std::cout << "  --workers <N>          ģʽ߳ (Ĭ: CPU)" << std::endl;
+                std::cout << "  --gop <N>              ģʽֿGOP (Ĭ: 250)" << std::endl;
+                std::cout << "  --results <·>       ģʽ֡CSV" << std::endl;
+                std::cout << "  --golden_record <·> ¼׶ϣο汾" << std::endl;
+                std::cout << "  --golden_check <·>  goldenļ֡ȶԣ汾֧ --offline" << std::endl;
+                std::cout << "  --bundle <·>        ģ/ðģ" << std::endl;
+                std::cout << "  --pool_alloc           ͼ񻺳ߴּã64ֽڶ롢Ԥȴҳ" << std::endl;
+                std::cout << "  --huge_pages            --pool_alloc󻺳ʹ͸ҳ (Linux)" << std::endl;
+                std::cout << "  --hot_reload           bundle ļ滻ͣ¼ģ" << std::endl;
+                std::cout << "  --make_bundle <·>   ģĿ¼Ĭϲģ/ð" << std::endl;
+                std::cout << "  --calib <·>         bundleʱд궨 (YAML)" << std::endl;
                 std::cout << "  --save                 洦Ƶ" << std::endl;
                 std::cout << "  --help, -h             ʾ˰Ϣ" << std::endl;
                 exit(0);
             }
         }
 
+        // ģʽ鲢д֡Ľ׶ιϣع֡ģʽ
+        if (config.offline && (!config.golden_record.empty() || !config.golden_check.empty())) {
+            throw std::runtime_error("--offline ֧ --golden_record / --golden_check");
+        }
+
         return config;
     }
 
@@ -67,6 +228,99 @@ namespace AutoAim {
         return hsv_frame;
     }
 
+    // תΪBGRʾ/棩
+    cv::Mat Utils::toBGR(const cv::Mat& frame, PixelFormat format) {
+        cv::Mat bgr;
+        switch (format) {
+        case PixelFormat::YUYV:
+            cv::cvtColor(frame, bgr, cv::COLOR_YUV2BGR_YUYV);
+            break;
+        case PixelFormat::NV12:
+            cv::cvtColor(frame, bgr, cv::COLOR_YUV2BGR_NV12);
+            break;
+        default:
+            bgr = frame.clone();
+            break;
+        }
+        return bgr;
+    }
+
+    // BGRתΪYUYV/NV12¼ģԭYUV
+    cv::Mat Utils::bgr2yuv(const cv::Mat& bgr_frame, PixelFormat format) {
+        if (format == PixelFormat::BGR) {
+            return bgr_frame;
+        }
+
+        //  BT.601 YCbCr޷ΧCOLOR_BGR2YUV ΪģYUVȫΧϵ
+        //  toBGR Ľ벻ӦɫȷҲʵͬ
+        int rows = bgr_frame.rows & ~1;
+        int cols = bgr_frame.cols & ~1;
+        cv::Mat out;
+
+        if (format == PixelFormat::YUYV) {
+            out.create(rows, cols, CV_8UC2);
+            for (int r = 0; r < rows; ++r) {
+                const uchar* src = bgr_frame.ptr<uchar>(r);
+                uchar* dst = out.ptr<uchar>(r);
+                for (int c = 0; c < cols; c += 2, src += 6, dst += 4) {
+                    dst[0] = bt601Luma(src);
+                    dst[1] = chromaAverage(bt601U(src) + bt601U(src + 3), 2);
+                    dst[2] = bt601Luma(src + 3);
+                    dst[3] = chromaAverage(bt601V(src) + bt601V(src + 3), 2);
+                }
+            }
+        }
+        else {
+            out.create(rows * 3 / 2, cols, CV_8UC1);
+            for (int r = 0; r < rows; r += 2) {
+                const uchar* src0 = bgr_frame.ptr<uchar>(r);
+                const uchar* src1 = bgr_frame.ptr<uchar>(r + 1);
+                uchar* y0 = out.ptr<uchar>(r);
+                uchar* y1 = out.ptr<uchar>(r + 1);
+                uchar* uv = out.ptr<uchar>(rows + r / 2);
+                for (int c = 0; c < cols; c += 2) {
+                    const uchar* p[4] = { src0 + 3 * c, src0 + 3 * c + 3, src1 + 3 * c, src1 + 3 * c + 3 };
+                    y0[c] = bt601Luma(p[0]);
+                    y0[c + 1] = bt601Luma(p[1]);
+                    y1[c] = bt601Luma(p[2]);
+                    y1[c + 1] = bt601Luma(p[3]);
+                    uv[c] = chromaAverage(bt601U(p[0]) + bt601U(p[1]) + bt601U(p[2]) + bt601U(p[3]), 4);
+                    uv[c + 1] = chromaAverage(bt601V(p[0]) + bt601V(p[1]) + bt601V(p[2]) + bt601V(p[3]), 4);
+                }
+            }
+        }
+
+        return out;
+    }
+
+    // ȡͼߴ磨NV12Yƽ㣩
+    cv::Size Utils::frameSize(const cv::Mat& frame, PixelFormat format) {
+        if (format == PixelFormat::NV12) {
+            return cv::Size(frame.cols, frame.rows * 2 / 3);
+        }
+        return cv::Size(frame.cols, frame.rows);
+    }
+
+    // ȡROIͼת֡
+    cv::Mat Utils::getLumaROI(const cv::Mat& frame, PixelFormat format, const cv::Rect& roi) {
+        cv::Rect safe_roi = roi & cv::Rect(cv::Point(0, 0), frameSize(frame, format));
+        if (safe_roi.empty()) {
+            return cv::Mat();
+        }
+
+        if (format == PixelFormat::YUYV) {
+            // YUYVUVɶԳ֣ROI뵽ż
+            int x1 = safe_roi.x & ~1;
+            int x2 = std::min((safe_roi.x + safe_roi.width + 1) & ~1, frame.cols & ~1);
+            cv::Mat gray;
+            cv::cvtColor(frame(cv::Rect(x1, safe_roi.y, x2 - x1, safe_roi.height)), gray, cv::COLOR_YUV2GRAY_YUYV);
+            return gray;
+        }
+
+        // NV12Yƽ漴ҶͼBGRһֱROI
+        return frame(safe_roi);
+    }
+
     // ɫָɫֵȡ
     cv::Mat Utils::colorSegmentation(const cv::Mat& frame, const std::string& color) {
         cv::Mat hsv = bgr2hsv(frame);
@@ -119,6 +373,34 @@ namespace AutoAim {
         cv::Point size_pos(armor.bounding_rect.x + armor.bounding_rect.width - 15,
             armor.bounding_rect.y + 15);
         cv::putText(frame, size_text, size_pos, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 0), 2);
+
+        // ˫ɫģʽ±עɫ
+        if (armor.color != LightColor::NONE) {
+            bool red = armor.color == LightColor::RED;
+            cv::Point color_pos(armor.bounding_rect.x, armor.bounding_rect.y + armor.bounding_rect.height + 15);
+            cv::putText(frame, red ? "R" : "B", color_pos, cv::FONT_HERSHEY_SIMPLEX, 0.5,
+                red ? cv::Scalar(0, 0, 255) : cv::Scalar(255, 0, 0), 2);
+        }
+    }
+
+    // ͳϢ
+    void Utils::drawStats(cv::Mat& frame, int frame_count, double fps, const std::string& enemy_color) {
+        // ʾ֡
+        std::string frame_text = "Frame: " + std::to_string(frame_count);
+        cv::putText(frame, frame_text, cv::Point(10, 30),
+            cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 255, 255), 2);
+
+        // ʾFPS
+        if (fps > 0) {
+            std::string fps_text = "FPS: " + std::to_string(static_cast<int>(fps));
+            cv::putText(frame, fps_text, cv::Point(10, 60),
+                cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 255, 255), 2);
+        }
+
+        // ʾзɫ
+        std::string color_text = "Enemy: " + enemy_color;
+        cv::putText(frame, color_text, cv::Point(10, 90),
+            cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 255, 255), 2);
     }
 
     // Ƶ
@@ -159,7 +441,8 @@ namespace AutoAim {
 
     // ӡϢ
     void Utils::debugPrint(const std::string& message) {
-        std::cout << "[" << getCurrentTime() << "] " << message << std::endl;
+        // ʱ־߳ɣڵ߳ϸʽˢstdout
+        Logger::instance().logText(LogLevel::Info, message);
     }
 
     // ֮ľ
@@ -188,10 +471,17 @@ namespace AutoAim {
 
     // ʾͼ񣨵ã
     void Utils::showImage(const std::string& window_name, const cv::Mat& image, int delay_ms) {
+#ifndef AUTO_AIM_NO_GUI
         if (!image.empty()) {
             cv::imshow(window_name, image);
             cv::waitKey(delay_ms);
         }
+#else
+        // Ŀⲻhighgui
+        (void)window_name;
+        (void)image;
+        (void)delay_ms;
+#endif
     }
 
     // ͼ񣨵ã
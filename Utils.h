@@ -4,17 +4,95 @@
 #include <opencv2/opencv.hpp>
 #include <string>
 #include <vector>
+#include "PixelFormat.hpp"
 
 namespace AutoAim {
 
+    // ɫֵͬʱǩеֵ
+    enum class LightColor : uchar {
+        NONE = 0,
+        RED = 1,
+        BLUE = 2
+    };
+
     // ṹ
     struct Config {
         std::string input_path;      // Ƶ·
         std::string output_path;     // Ƶ·
-        std::string enemy_color;     // зɫ: "red"  "blue"
+        std::string enemy_color;     // зɫ: "red""blue"  "both"˫ɫͬʱ⣩
         int camera_id;               // ͷID
         bool show_result;            // Ƿʾ
         bool save_result;            // Ƿ񱣴
+        PixelFormat input_format;    // ظʽ
+        bool validate_yuv;           // BGRƵתΪYUVԱָ·
+        double display_fps;          // Ԥˢ
+        double preview_scale;        // Ԥͼű
+        std::string shm_name;        // ڴ淢ƣΪ򲻷
+        std::string log_path;        // ʽ־·Ϊ򲻼¼
+        bool adaptive_threshold;     // ֡ͳӦֵָ
+        bool sparse_mask;            // ʹг̱ϡ
+        bool brightness_first;       // ֵںѡں˶ɫ
+        std::string color_lut_path;  // 궨ɫұΪʹHSVֵ
+        int stream_bands;            // ʽÿ0Ϊ֡
+        double readout_ms;           // ʽģ֡ʱ
+        bool sim_camera;             // Ƶļʵʱ֡ʻطţģ
+        double sim_fps;              // ģ֡ʣ0Ϊļ֡
+        int sim_buffer;              // ģ֡
+        double sim_jitter_ms;        // ģɼʱ̶
+        std::string record_dir;      // м¼תĿ¼Ϊ򲻼¼
+        double record_seconds;       // м¼
+        bool offline;                // ߷ֿ鲢дƵļ
+        int workers;                 // ģʽ߳0ΪCPU
+        int gop_size;                // ģʽֿGOP
+        std::string results_path;    // ģʽ֡CSV·
+        std::string golden_record;   // ¼׶ιϣgoldenļ
+        std::string golden_check;    // goldenļ֡ȶ
+        std::string bundle_path;     // ģ/ð·ΪģĿ¼
+        std::string make_bundle;     // ģ/ð·˳
+        bool hot_reload;             // bundleļ滻ͣ¼
+        bool pool_allocator;         // ˮͼʹ÷ּĶ
+        bool huge_pages;             // Ĵ󻺳͸ҳ
+        std::string calib_path;      // bundleʱʹõ궨ļYAML
+
+        // 캯Ĭֵ
+        Config() :
+            input_path(""),
+            output_path("output.mp4"),
+            enemy_color("red"),
+            camera_id(0),
+            show_result(true),
+            save_result(false),
+            input_format(PixelFormat::BGR),
+            validate_yuv(false),
+            display_fps(30.0),
+            preview_scale(0.5),
+            shm_name(""),
+            log_path(""),
+            adaptive_threshold(false),
+            sparse_mask(false),
+            brightness_first(false),
+            color_lut_path(""),
+            stream_bands(0),
+            readout_ms(8.0),
+            sim_camera(false),
+            sim_fps(0.0),
+            sim_buffer(3),
+            sim_jitter_ms(0.0),
+            record_dir(""),
+            record_seconds(3.0),
+            offline(false),
+            workers(0),
+            gop_size(250),
+            results_path(""),
+            golden_record(""),
+            golden_check(""),
+            bundle_path(""),
+            make_bundle(""),
+            hot_reload(false),
+            pool_allocator(false),
+            huge_pages(false),
+            calib_path("") {
+        }
     };
 
     // װװṹ
@@ -23,13 +101,15 @@ namespace AutoAim {
         cv::RotatedRect right_light;  // ҵ
         cv::Rect bounding_rect;       // װװ
         int number;                   // ʶ𵽵
-        double confidence;            // Ŷ
+        double confidence;            // Ŷȣģƥ÷֣
         bool is_large;                // ǷΪװװ
+        LightColor color;             // ɫ
 
-        Armor() : number(-1), confidence(0.0), is_large(false) {}
+        // 캯
+        Armor() : number(-1), confidence(0.0), is_large(false), color(LightColor::NONE) {}
     };
 
-    // ߺ
+    // ߺ
     class Utils {
     public:
         // в
@@ -38,12 +118,27 @@ namespace AutoAim {
         // ɫתBGRתHSV
         static cv::Mat bgr2hsv(const cv::Mat& bgr_frame);
 
+        // תΪBGRʾ/棩
+        static cv::Mat toBGR(const cv::Mat& frame, PixelFormat format);
+
+        // BGRתΪYUYV/NV12¼ģԭYUV
+        static cv::Mat bgr2yuv(const cv::Mat& bgr_frame, PixelFormat format);
+
+        // ȡͼߴ磨NV12Yƽ㣩
+        static cv::Size frameSize(const cv::Mat& frame, PixelFormat format);
+
+        // ȡROIͼת֡
+        static cv::Mat getLumaROI(const cv::Mat& frame, PixelFormat format, const cv::Rect& roi);
+
         // ɫָɫֵȡ
         static cv::Mat colorSegmentation(const cv::Mat& frame, const std::string& color);
 
         // װװ
         static void drawArmor(cv::Mat& frame, const Armor& armor);
 
+        // ͳϢ֡š֡ʡзɫ
+        static void drawStats(cv::Mat& frame, int frame_count, double fps, const std::string& enemy_color);
+
         // Ƶ
         static void drawLightBar(cv::Mat& frame, const cv::RotatedRect& light);
 
@@ -52,6 +147,30 @@ namespace AutoAim {
 
         // ӡϢ
         static void debugPrint(const std::string& message);
+
+        // ֵڷΧ
+        template<typename T>
+        static T clamp(T value, T min_val, T max_val) {
+            return (value < min_val) ? min_val : ((value > max_val) ? max_val : value);
+        }
+
+        // ֮ľ
+        static double distance(const cv::Point2f& p1, const cv::Point2f& p2);
+
+        // ȡתεĸ
+        static std::vector<cv::Point2f> getRotatedRectVertices(const cv::RotatedRect& rect);
+
+        // ȫػȡROI
+        static cv::Mat getSafeROI(const cv::Mat& frame, const cv::Rect& roi);
+
+        // ʾͼ񣨵ã
+        static void showImage(const std::string& window_name, const cv::Mat& image, int delay_ms = 1);
+
+        // ͼ񣨵ã
+        static void saveImage(const std::string& filename, const cv::Mat& image);
+
+        // ļǷ
+        static bool fileExists(const std::string& filename);
     };
 
 } // namespace AutoAim
@@ -1,11 +1,33 @@
 #include "VideoProcessor.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <chrono>
 
 namespace AutoAim {
 
     VideoProcessor::VideoProcessor(const Config& config)
-        : config_(config), frame_count_(0), total_time_(0.0) {
+        : config_(config),
+        renderer_(config.input_path.empty() ? "AutoAim - ͷģʽ" : "AutoAim - Զ׼ϵͳ",
+            config.enemy_color, config.display_fps, config.preview_scale),
+        frame_count_(0), total_time_(0.0), tail_latency_total_(0.0),
+        validate_bgr_count_(0), validate_yuv_count_(0), validate_matched_(0),
+        startup_time_(std::chrono::steady_clock::now()), startup_reported_(false) {
+
+        if (config_.validate_yuv && config_.input_format == PixelFormat::BGR) {
+            config_.input_format = PixelFormat::YUYV;
+        }
+
+        // ɫұ궨̻˷ָӦֵֵֶֻܵ
+        if (config_.adaptive_threshold && !config_.color_lut_path.empty()) {
+            std::cerr << ": --adaptive  --color_lut ͬʱʹʱֵֵֶֻ" << std::endl;
+        }
+
+        // ʽֻеɫָҪ֡ĺѡ
+        if (config_.stream_bands > 0 && config_.brightness_first) {
+            throw std::runtime_error("--bright_first  --stream_bands ͬʱʹ!");
+        }
 
         // ʼƵ
         if (!config_.input_path.empty()) {
@@ -19,6 +41,11 @@ namespace AutoAim {
             throw std::runtime_error("޷ƵԴ!");
         }
 
+        // ԭYUVرڵRGBתֱȡԭʼ
+        if (config_.input_path.empty() && config_.input_format != PixelFormat::BGR) {
+            cap_.set(cv::CAP_PROP_CONVERT_RGB, 0);
+        }
+
         // ʼƵдҪ棩
         if (config_.save_result && !config_.output_path.empty()) {
             int codec = cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
@@ -34,56 +61,289 @@ namespace AutoAim {
             }
         }
 
-        // ʼʶ
-        number_recognizer_.loadTemplates("data/templates");
+        // ʼ־
+        if (!config_.log_path.empty() && !log_writer_.open(config_.log_path)) {
+            std::cerr << ": ޷򿪼־¼" << std::endl;
+        }
+
+        // ʼع
+        if (!config_.golden_record.empty()) {
+            if (!golden_.open(config_.golden_record, GoldenTrace::RECORD)) {
+                throw std::runtime_error("޷goldenļ!");
+            }
+        }
+        else if (!config_.golden_check.empty() &&
+            !golden_.open(config_.golden_check, GoldenTrace::CHECK)) {
+            throw std::runtime_error("޷goldenļ!");
+        }
+
+        // ʼм¼֡ʻ㱣֡
+        if (!config_.record_dir.empty() && config_.record_seconds > 0.0) {
+            double fps = (config_.sim_camera && config_.sim_fps > 0.0) ? config_.sim_fps : cap_.get(cv::CAP_PROP_FPS);
+            if (fps <= 0.0) {
+                fps = 60.0;
+            }
+            int capacity = static_cast<int>(std::ceil(config_.record_seconds * fps));
+            if (recorder_.open(config_.record_dir, capacity)) {
+                FlightRecorder::installSignalHandler();
+            }
+        }
+
+        // ʼʶ
+        models_ = buildModels();
+
+        // ʼڴ淢bundle 궨ʱڲһ˾ݴ׼
+        // زѷڲ
+        if (!config_.shm_name.empty() && !publisher_.open(config_.shm_name, models_->bundle->cameraMatrix())) {
+            std::cerr << ": ޷ڴ棬" << std::endl;
+        }
+
+        // أbundle ļ滻ں̨ؽ
+        if (config_.hot_reload) {
+            if (config_.bundle_path.empty()) {
+                std::cerr << ": Ҫ --bundleδ" << std::endl;
+            }
+            else {
+                reloader_.reset(new ModelReloader(config_.bundle_path,
+                    [this]() -> std::unique_ptr<DetectorSnapshot> {
+                        try {
+                            std::unique_ptr<DetectorSnapshot> models = buildModels();
+                            if (!models->bundle->isLoaded()) {
+                                return std::unique_ptr<DetectorSnapshot>();
+                            }
+                            return models;
+                        }
+                        catch (const std::exception& e) {
+                            Logger::instance().logText(LogLevel::Error, std::string("عʧ: ") + e.what());
+                            return std::unique_ptr<DetectorSnapshot>();
+                        }
+                    }));
+            }
+        }
+    }
+
+    std::unique_ptr<DetectorSnapshot> VideoProcessor::buildModels() const {
+        std::unique_ptr<DetectorSnapshot> models(new DetectorSnapshot());
+        LightBarDetector light_detector(config_.enemy_color);
+        light_detector.setSparseMask(config_.sparse_mask);
+        light_detector.setBrightnessFirst(config_.brightness_first);
+
+        if (!config_.color_lut_path.empty()) {
+            std::shared_ptr<ColorLut> lut = std::make_shared<ColorLut>();
+            if (!lut->load(config_.color_lut_path)) {
+                throw std::runtime_error("޷ɫұ!");
+            }
+            light_detector.setColorLut(lut);
+        }
+
+        if (!config_.bundle_path.empty() && models->bundle->load(config_.bundle_path)) {
+            // bundleԤõģ壬ͼ
+            models->bundle->apply(light_detector, models->armor_detector, models->number_recognizer);
+        }
+        else {
+            models->number_recognizer.loadTemplates("data/templates");
+        }
+
+        models->armor_detector.setLightBarDetector(light_detector);
+        return models;
+    }
+
+    void VideoProcessor::swapModels() {
+        if (!reloader_) {
+            return;
+        }
+
+        std::unique_ptr<DetectorSnapshot> next = reloader_->acquire();
+        if (next) {
+            models_.swap(next);
+            reloader_->retire(std::move(next));
+        }
+    }
+
+    void VideoProcessor::applyAdaptiveThreshold(const cv::Mat& frame, PixelFormat format,
+        ArmorDetector& armor_detector, NumberRecognizer& number_recognizer) {
+        adaptive_.update(frame, format);
+        if (format == PixelFormat::BGR) {
+            armor_detector.setColorThreshold(adaptive_.saturationMin(), adaptive_.valueMin());
+        }
+        else {
+            armor_detector.setYUVThreshold(adaptive_.lumaMin(), armor_detector.yuvChromaThreshold());
+        }
+        number_recognizer.setBinaryThreshold(adaptive_.numberThreshold());
+    }
+
+    void VideoProcessor::logDetections(uint64_t frame_index, int64_t timestamp_ns,
+        const std::vector<Armor>& armors) {
+        for (const auto& armor : armors) {
+            LogDetection d;
+            d.frame_index = frame_index;
+            d.timestamp_ns = timestamp_ns;
+            const cv::RotatedRect* lights[2] = { &armor.left_light, &armor.right_light };
+            float* out[2] = { d.left, d.right };
+            for (int k = 0; k < 2; ++k) {
+                out[k][0] = lights[k]->center.x;
+                out[k][1] = lights[k]->center.y;
+                out[k][2] = lights[k]->size.width;
+                out[k][3] = lights[k]->size.height;
+                out[k][4] = lights[k]->angle;
+            }
+            d.rect[0] = armor.bounding_rect.x;
+            d.rect[1] = armor.bounding_rect.y;
+            d.rect[2] = armor.bounding_rect.width;
+            d.rect[3] = armor.bounding_rect.height;
+            d.number = armor.number;
+            d.confidence = static_cast<float>(armor.confidence);
+            d.is_large = armor.is_large ? 1 : 0;
+            d.color = static_cast<uint8_t>(armor.color);
+            log_writer_.append(d);
+        }
     }
 
     void VideoProcessor::process() {
         cv::Mat frame;
         int frame_num = 0;
 
+        // ʽģʽƵ֡д뻺ģж
+        SyntheticBandSource band_source(config_.stream_bands, config_.readout_ms);
+        RowStreamSource* stream = config_.stream_bands > 0 ? &band_source : nullptr;
+
+        // ģʵʱ֡ʻطţʱ֡ѹ򱻸
+        std::unique_ptr<SimulatedCamera> camera;
+        if (config_.sim_camera) {
+            camera.reset(new SimulatedCamera(cap_, config_.sim_fps, config_.sim_buffer, config_.sim_jitter_ms));
+            std::cout << "ģ: " << camera->fps() << " FPS " << config_.sim_buffer << " ֡" << std::endl;
+        }
+        double result_age_total_ms = 0.0;
+        double result_age_max_ms = 0.0;
+
         auto start_time = std::chrono::high_resolution_clock::now();
 
+        if (config_.show_result) {
+            renderer_.start();
+        }
+        if (camera) {
+            camera->start();
+        }
+
         while (true) {
-            cap_ >> frame;
-            if (frame.empty()) {
-                break;
+            int64_t capture_ns = 0;
+            if (camera) {
+                if (!camera->read(frame, capture_ns)) {
+                    break;
+                }
+            }
+            else {
+                cap_ >> frame;
+                if (frame.empty()) {
+                    break;
+                }
+                capture_ns = shmNowNs();
             }
 
             frame_num++;
-            std::cout << "֡: " << frame_num << "\r" << std::flush;
+            Logger::instance().progress(frame_num);
+
+            // ƵļΪBGRתΪYUVģԭYUV
+            cv::Mat input = frame;
+            if (config_.input_format != PixelFormat::BGR) {
+                input = Utils::bgr2yuv(frame, config_.input_format);
+                if (config_.validate_yuv) {
+                    validateYUV(frame, input);
+                }
+            }
+
+            if (stream != nullptr) {
+                input = band_source.start(input);
+            }
 
             // ǰ֡
             auto frame_start = std::chrono::high_resolution_clock::now();
-            cv::Mat result = processFrame(frame);
+            std::vector<Armor> armors = processFrame(input, capture_ns, stream);
             auto frame_end = std::chrono::high_resolution_clock::now();
 
             double frame_time = std::chrono::duration<double>(frame_end - frame_start).count();
             total_time_ += frame_time;
 
-            // ʾ
+            // ֡ʣӳ٣ʽģʽ´󲿷ּص
+            tail_latency_total_ += (stream != nullptr)
+                ? std::chrono::duration<double>(std::chrono::steady_clock::now() - band_source.completeTime()).count()
+                : frame_time;
+
+            // ʱ֡
+            if (camera) {
+                double age_ms = (shmNowNs() - capture_ns) / 1e6;
+                result_age_total_ms += age_ms;
+                result_age_max_ms = std::max(result_age_max_ms, age_ms);
+            }
+
+            if (publisher_.isOpen()) {
+                publisher_.publish(frame_num, capture_ns, armors);
+            }
+
+            if (log_writer_.isOpen()) {
+                logDetections(frame_num, capture_ns, armors);
+            }
+
+            // ʾȾ߳٣⣩
             if (config_.show_result) {
-                displayStats(result, frame_num, 1.0 / frame_time);
-                cv::imshow("AutoAim - Զ׼ϵͳ", result);
+                FrameStats stats;
+                stats.frame_count = frame_num;
+                stats.fps = 1.0 / frame_time;
+                renderer_.submit(input, config_.input_format, armors, stats);
 
-                if (cv::waitKey(1) == 27) {  // ESC˳
+                if (renderer_.stopRequested()) {  // ESC˳
                     break;
                 }
+                if (renderer_.takeDumpRequest()) {
+                    recorder_.trigger();
+                }
             }
 
             // 
             if (config_.save_result && writer_.isOpened()) {
+                cv::Mat result = renderFrame(input, armors);
+                displayStats(result, frame_num, 1.0 / frame_time);
                 writer_.write(result);
             }
         }
 
+        renderer_.stop();
+        if (camera) {
+            camera->stop();
+        }
+        Logger::instance().flush();
+
         auto end_time = std::chrono::high_resolution_clock::now();
         double total_elapsed = std::chrono::duration<double>(end_time - start_time).count();
 
-        std::cout << "\n!" << std::endl;
+        std::cout << "!" << std::endl;
         std::cout << "֡: " << frame_num << std::endl;
         std::cout << "ʱ: " << total_elapsed << " " << std::endl;
         std::cout << "ƽ֡: " << frame_num / total_elapsed << " FPS" << std::endl;
+        if (frame_num > 0) {
+            std::cout << "֡ƽӳ: " << tail_latency_total_ / frame_num * 1000.0 << " ms"
+                << (stream != nullptr ? "ʽ" : "") << std::endl;
+        }
+        if (camera) {
+            std::cout << "ģ: ɼ " << camera->captured() << " ֡ " << camera->delivered()
+                << " ֡ " << camera->overwritten() << " ֡ɼ " << camera->skipped() << " ֡" << std::endl;
+            std::cout << "֡: ȡ֡ʱƽ " << camera->meanAgeMs() << " ms " << camera->maxAgeMs()
+                << " msʱƽ " << (frame_num > 0 ? result_age_total_ms / frame_num : 0.0)
+                << " ms " << result_age_max_ms << " ms" << std::endl;
+        }
+
+        golden_.finish();
+
+        if (recorder_.isOpen()) {
+            recorder_.wait();
+            std::cout << "м¼: ת " << recorder_.dumps() << " " << std::endl;
+        }
+
+        if (config_.validate_yuv) {
+            std::cout << "YUV֤: BGRװװ " << validate_bgr_count_
+                << "YUVװװ " << validate_yuv_count_
+                << "һ " << validate_matched_ << std::endl;
+        }
     }
 
     void VideoProcessor::processCamera() {
@@ -92,103 +352,184 @@ namespace AutoAim {
 
         std::cout << "ESC˳ͷɼ..." << std::endl;
 
+        renderer_.start();
+
         while (true) {
             cap_ >> frame;
             if (frame.empty()) {
                 break;
             }
 
+            int64_t capture_ns = shmNowNs();
             frame_num++;
 
+            if (config_.input_format != PixelFormat::BGR) {
+                frame = wrapRawFrame(frame);
+            }
+
             // ǰ֡
-            cv::Mat result = processFrame(frame);
-            displayStats(result, frame_num, 0);
+            std::vector<Armor> armors = processFrame(frame, capture_ns);
+
+            if (publisher_.isOpen()) {
+                publisher_.publish(frame_num, capture_ns, armors);
+            }
+
+            if (log_writer_.isOpen()) {
+                logDetections(frame_num, capture_ns, armors);
+            }
 
             // ʾ
-            cv::imshow("AutoAim - ͷģʽ", result);
+            FrameStats stats;
+            stats.frame_count = frame_num;
+            renderer_.submit(frame, config_.input_format, armors, stats);
 
-            if (cv::waitKey(1) == 27) {  // ESC˳
+            if (renderer_.stopRequested()) {  // ESC˳
                 break;
             }
+            if (renderer_.takeDumpRequest()) {
+                recorder_.trigger();
+            }
         }
+
+        renderer_.stop();
     }
 
-    cv::Mat VideoProcessor::processFrame(const cv::Mat& frame) {
-        cv::Mat result = frame.clone();
+    std::vector<Armor> VideoProcessor::processFrame(const cv::Mat& frame, int64_t capture_ns,
+        RowStreamSource* stream) {
+        const PixelFormat format = config_.input_format;
+        std::vector<Armor> armors;
+        frame_count_++;
+
+        // عм¼ʱм
+        DetectionTrace trace;
+        DetectionTrace* trace_ptr = (golden_.isOpen() || recorder_.isOpen()) ? &trace : nullptr;
+        FrameHashes hashes;
+
+        // ֡ʹͬһݼֻ֡Ч
+        swapModels();
+        ArmorDetector& armor_detector = models_->armor_detector;
+        NumberRecognizer& number_recognizer = models_->number_recognizer;
 
         try {
+            // Ӧֵϡͳȣ·ֵֵֶָ
+            // ʽģʽ±֡δΪ£һ֡
+            if (config_.adaptive_threshold && stream == nullptr) {
+                applyAdaptiveThreshold(frame, format, armor_detector, number_recognizer);
+            }
+
             // װװ
-            std::vector<Armor> armors = armor_detector_.detect(frame);
+            armors = (stream != nullptr)
+                ? armor_detector.detectStream(*stream, frame, format, trace_ptr)
+                : armor_detector.detect(frame, format, trace_ptr);
+
+            if (golden_.isOpen()) {
+                // г̱·ֻΪعչ룬ϣ·ɱ
+                hashes.mask = GoldenTrace::hashMat(trace.binary.empty() ? trace.mask.toMat() : trace.binary);
+                hashes.light_bars = GoldenTrace::hashLightBars(trace.light_bars);
+                hashes.armors = GoldenTrace::hashArmors(armors);
+            }
 
             // ÿװװʶ
             for (auto& armor : armors) {
-                // ȡROI
-                cv::Mat roi = frame(armor.bounding_rect);
+                // ֱ͸ӲYUVֱȡȣ
+                cv::Mat patch = NumberRecognizer::extractNumberPatch(frame, format,
+                    armor.left_light, armor.right_light);
 
                 // ʶ
-                armor.number = number_recognizer_.recognize(roi);
+                armor.number = number_recognizer.recognizePatch(patch, &armor.confidence);
+            }
+
+            if (config_.adaptive_threshold && stream != nullptr) {
+                applyAdaptiveThreshold(frame, format, armor_detector, number_recognizer);
+            }
+        }
+        catch (const std::exception& e) {
+            Logger::instance().logText(LogLevel::Error, std::string("֡ʱ: ") + e.what());
+        }
 
-                // ƽ
-                Utils::drawArmor(result, armor);
+        if (golden_.isOpen()) {
+            hashes.numbers = GoldenTrace::hashNumbers(armors);
+            golden_.addFrame(frame_count_, hashes);
+        }
 
-                // װװϷʾʶ
-                if (armor.number != -1) {
-                    std::string text = "Num: " + std::to_string(armor.number);
-                    cv::putText(result, text,
-                        cv::Point(armor.bounding_rect.x, armor.bounding_rect.y - 10),
-                        cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 255, 0), 2);
-                }
+        if (recorder_.isOpen()) {
+            recorder_.record(frame_count_, capture_ns, frame, format, trace.binary, trace.mask,
+                trace.light_bars, armors);
+        }
 
-                // ʾСװװϢ
-                std::string size_text = armor.is_large ? "Large" : "Small";
-                cv::putText(result, size_text,
-                    cv::Point(armor.bounding_rect.x, armor.bounding_rect.y - 30),
-                    cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 0), 1);
-            }
+        if (!startup_reported_) {
+            startup_reported_ = true;
+            int64_t startup_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - startup_time_).count();
+            Logger::instance().log(LogLevel::Info, "֡: {} us", startup_us);
+        }
 
-            // ûм⵽װװ壬ʾʾϢ
-            if (armors.empty()) {
-                cv::putText(result, "No armor detected",
-                    cv::Point(50, 50), cv::FONT_HERSHEY_SIMPLEX,
-                    1.0, cv::Scalar(0, 0, 255), 2);
-            }
+        return armors;
+    }
 
+    cv::Mat VideoProcessor::renderFrame(const cv::Mat& frame, const std::vector<Armor>& armors) {
+        cv::Mat result = Utils::toBGR(frame, config_.input_format);
+
+        for (const auto& armor : armors) {
+            Utils::drawArmor(result, armor);
         }
-        catch (const std::exception& e) {
-            std::cerr << "֡ʱ: " << e.what() << std::endl;
+
+        // ûм⵽װװ壬ʾʾϢ
+        if (armors.empty()) {
+            cv::putText(result, "No armor detected",
+                cv::Point(50, 50), cv::FONT_HERSHEY_SIMPLEX,
+                1.0, cv::Scalar(0, 0, 255), 2);
         }
 
         return result;
     }
 
+    cv::Mat VideoProcessor::wrapRawFrame(const cv::Mat& raw) {
+        // رRGBתصԭʼ֡ߴ½
+        if (raw.rows != 1) {
+            return raw;
+        }
+
+        int height = static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_HEIGHT));
+        if (config_.input_format == PixelFormat::YUYV) {
+            return raw.reshape(2, height);
+        }
+        return raw.reshape(1, height * 3 / 2);
+    }
+
+    void VideoProcessor::validateYUV(const cv::Mat& bgr_frame, const cv::Mat& yuv_frame) {
+        std::vector<Armor> bgr_armors = models_->armor_detector.detect(bgr_frame);
+        std::vector<Armor> yuv_armors = models_->armor_detector.detect(yuv_frame, config_.input_format);
+
+        validate_bgr_count_ += static_cast<int>(bgr_armors.size());
+        validate_yuv_count_ += static_cast<int>(yuv_armors.size());
+
+        // ľСڵ߶һΪͬһװװ
+        for (const auto& a : bgr_armors) {
+            cv::Point2f ca = (a.left_light.center + a.right_light.center) * 0.5f;
+            float tol = (a.left_light.size.height + a.right_light.size.height) / 4.0f;
+            for (const auto& b : yuv_armors) {
+                cv::Point2f cb = (b.left_light.center + b.right_light.center) * 0.5f;
+                if (Utils::distance(ca, cb) < tol) {
+                    validate_matched_++;
+                    break;
+                }
+            }
+        }
+    }
+
     void VideoProcessor::saveFrame(const cv::Mat& frame) {
         if (writer_.isOpened()) {
             writer_.write(frame);
         }
     }
 
+    bool VideoProcessor::goldenPassed() {
+        return golden_.finish();
+    }
+
     void VideoProcessor::displayStats(cv::Mat& frame, int frame_count, double fps) {
-        // ʾ֡
-        std::string frame_text = "Frame: " + std::to_string(frame_count);
-        cv::putText(frame, frame_text, cv::Point(10, 30),
-            cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 255, 255), 2);
-
-        // ʾFPS
-        if (fps > 0) {
-            std::string fps_text = "FPS: " + std::to_string(static_cast<int>(fps));
-            cv::putText(frame, fps_text, cv::Point(10, 60),
-                cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 255, 255), 2);
-        }
-
-        // ʾзɫ
-        std::string color_text = "Enemy: " + config_.enemy_color;
-        cv::putText(frame, color_text, cv::Point(10, 90),
-            cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 255, 255), 2);
-
-        // ʾǰʱ
-        std::string time_text = "Time: " + Utils::getCurrentTime();
-        cv::putText(frame, time_text, cv::Point(10, 120),
-            cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(200, 200, 200), 1);
+        Utils::drawStats(frame, frame_count, fps, config_.enemy_color);
     }
 
 } // namespace AutoAim
\ No newline at end of file
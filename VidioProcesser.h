@@ -2,9 +2,19 @@
 #define VIDEO_PROCESSOR_HPP
 
 #include <opencv2/opencv.hpp>
+#include <chrono>
 #include <string>
 #include "ArmorDetector.hpp"
 #include "NumberRecognizer.hpp"
+#include "OverlayRenderer.hpp"
+#include "DetectionPublisher.hpp"
+#include "DetectionLog.hpp"
+#include "AdaptiveThreshold.hpp"
+#include "GoldenTrace.hpp"
+#include "ModelBundle.hpp"
+#include "ModelReloader.hpp"
+#include "SimulatedCamera.hpp"
+#include "FlightRecorder.hpp"
 
 namespace AutoAim {
 
@@ -18,8 +28,14 @@ namespace AutoAim {
         // ͷ
         void processCamera();
 
-        // ֡
-        cv::Mat processFrame(const cv::Mat& frame);
+        // ֡ʶ𣬲
+        // capture_ns Ϊ֡Ĳɼʱ䣨м¼ã
+        // stream ǿʱ frame ΪдĻ߽ձ߼
+        std::vector<Armor> processFrame(const cv::Mat& frame, int64_t capture_ns,
+            RowStreamSource* stream = nullptr);
+
+        // ȫֱͼϻƼƵã
+        cv::Mat renderFrame(const cv::Mat& frame, const std::vector<Armor>& armors);
 
         // 
         void saveFrame(const cv::Mat& frame);
@@ -27,14 +43,49 @@ namespace AutoAim {
         // ʾͳϢ
         void displayStats(cv::Mat& frame, int frame_count, double fps);
 
+        // عǷͨδʱΪtrue
+        bool goldenPassed();
+
+    private:
+        // ԭʼװΪYUYV/NV12ͼ
+        cv::Mat wrapRawFrame(const cv::Mat& raw);
+
+        // ԱYUVBGR·ļ
+        void validateYUV(const cv::Mat& bgr_frame, const cv::Mat& yuv_frame);
+
+        // bundleģĿ¼úõļʱں̵̨߳ã
+        std::unique_ptr<DetectorSnapshot> buildModels() const;
+
+        // ֡ȡط¿
+        void swapModels();
+
+        // õǰ֡ӦֵдBGR HSVޣYUV ֵ
+        void applyAdaptiveThreshold(const cv::Mat& frame, PixelFormat format,
+            ArmorDetector& armor_detector, NumberRecognizer& number_recognizer);
+
+        // д־
+        void logDetections(uint64_t frame_index, int64_t timestamp_ns, const std::vector<Armor>& armors);
+
     private:
         Config config_;
         cv::VideoCapture cap_;
         cv::VideoWriter writer_;
-        ArmorDetector armor_detector_;
-        NumberRecognizer number_recognizer_;
+        std::unique_ptr<DetectorSnapshot> models_;     // ǰbundleװװ⡢ʶ
+        std::unique_ptr<ModelReloader> reloader_;      // أδʱΪ
+        OverlayRenderer renderer_;
+        DetectionPublisher publisher_;
+        DetectionLogWriter log_writer_;
+        AdaptiveThreshold adaptive_;
+        GoldenTrace golden_;
+        FlightRecorder recorder_;
         int frame_count_;
         double total_time_;
+        double tail_latency_total_;  // ֡ﵽɵۼʱ
+        int validate_bgr_count_;     // ֤BGR·װװ
+        int validate_yuv_count_;     // ֤YUV·װװ
+        int validate_matched_;       // ֤·һµװװ
+        std::chrono::steady_clock::time_point startup_time_;    // 쿪ʼʱ
+        bool startup_reported_;      // Ƿʱ
     };
 
 } // namespace AutoAim
@@ -1,8 +1,32 @@
 #include <iostream>
 #include <opencv2/opencv.hpp>
 #include "VideoProcessor.hpp"
+#include "OfflineProcessor.hpp"
+#include "ModelBundle.hpp"
+#include "PooledAllocator.hpp"
 #include "Utils.hpp"
 
+// ģĿ¼Ĭϲ궨ģ/ð
+static int makeBundle(const AutoAim::Config& config) {
+    AutoAim::NumberRecognizer recognizer(false);
+    recognizer.loadTemplates("data/templates");
+
+    cv::Mat camera_matrix, dist_coeffs;
+    if (!config.calib_path.empty()) {
+        cv::FileStorage fs(config.calib_path, cv::FileStorage::READ);
+        if (!fs.isOpened()) {
+            std::cerr << ": ޷ȡ궨ļ " << config.calib_path << std::endl;
+            return -1;
+        }
+        fs["camera_matrix"] >> camera_matrix;
+        fs["dist_coeffs"] >> dist_coeffs;
+    }
+
+    bool ok = AutoAim::ModelBundle::write(config.make_bundle, AutoAim::BundleParams(),
+        recognizer.templates(), recognizer.templateLabels(), camera_matrix, dist_coeffs);
+    return ok ? 0 : -1;
+}
+
 int main(int argc, char** argv) {
     std::cout << "=== AutoAim Զ׼ϵͳ ===" << std::endl;
     std::cout << "汾: 1.0" << std::endl;
@@ -13,12 +37,32 @@ int main(int argc, char** argv) {
         // в
         AutoAim::Config config = AutoAim::Utils::parseArguments(argc, argv);
 
+        if (!config.make_bundle.empty()) {
+            return makeBundle(config);
+        }
+
+        // κˮͼ֮ǰװ
+        if (config.pool_allocator) {
+            AutoAim::PooledAllocator::install(config.huge_pages);
+        }
+
+        // ߷ֿ鲢д
+        if (config.offline) {
+            std::cout << "ߴƵļ: " << config.input_path << std::endl;
+            AutoAim::OfflineProcessor offline(config);
+            offline.process();
+            if (config.pool_allocator) {
+                AutoAim::PooledAllocator::instance().printStats();
+            }
+            return 0;
+        }
+
         // Ƶ
         AutoAim::VideoProcessor processor(config);
 
         // ʼ
         if (!config.input_path.empty()) {
-            std::cout << "Ƶļ: " << config.input_path "C:\Users\24388\Desktop\test01.avi" << std::endl;
+            std::cout << "Ƶļ: " << config.input_path << std::endl;
             processor.process();
         }
         else {
@@ -27,6 +71,14 @@ int main(int argc, char** argv) {
         }
 
         std::cout << "!" << std::endl;
+        if (config.pool_allocator) {
+            AutoAim::PooledAllocator::instance().printStats();
+        }
+
+        // عʧʱط
+        if (!processor.goldenPassed()) {
+            return 1;
+        }
 
     }
     catch (const std::exception& e) {